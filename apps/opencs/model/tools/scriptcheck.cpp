@@ -77,9 +77,10 @@ void CSMTools::ScriptCheckStage::perform (int stage, CSMDoc::Messages& messages)
         const CSMWorld::Data& data = mDocument.getData();
 
         mFile = data.getScripts().getRecord (stage).get().mId;
-        std::istringstream input (data.getScripts().getRecord (stage).get().mScriptText);
+        const std::string& source = data.getScripts().getRecord (stage).get().mScriptText;
 
-        Compiler::Scanner scanner (*this, input, mContext.getExtensions());
+        Compiler::Scanner scanner (*this, source.data(), source.data()+source.size(),
+            mContext.getExtensions());
 
         Compiler::FileParser parser (*this, mContext);
 
@@ -79,9 +79,10 @@ std::pair<char, bool> CSMWorld::ScriptContext::getMemberType (const std::string&
         Compiler::Locals locals;
 
         Compiler::NullErrorHandler errorHandler;
-        std::istringstream stream (mData.getScripts().getRecord (index).get().mScriptText);
+        const std::string& source = mData.getScripts().getRecord (index).get().mScriptText;
         Compiler::QuickFileParser parser (errorHandler, *this, locals);
-        Compiler::Scanner scanner (errorHandler, stream, getExtensions());
+        Compiler::Scanner scanner (errorHandler, source.data(), source.data()+source.size(),
+            getExtensions());
         scanner.scan (parser);
 
         iter = mLocals.insert (std::make_pair (id2, locals)).first;
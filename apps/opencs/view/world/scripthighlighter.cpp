@@ -1,8 +1,6 @@
 
 #include "scripthighlighter.hpp"
 
-#include <sstream>
-
 #include <components/compiler/scanner.hpp>
 #include <components/compiler/extensions0.hpp>
 
@@ -128,9 +126,10 @@ CSVWorld::ScriptHighlighter::ScriptHighlighter (const CSMWorld::Data& data, Mode
 
 void CSVWorld::ScriptHighlighter::highlightBlock (const QString& text)
 {
-    std::istringstream stream (text.toUtf8().constData());
+    QByteArray source = text.toUtf8();
 
-    Compiler::Scanner scanner (mErrorHandler, stream, mContext.getExtensions());
+    Compiler::Scanner scanner (mErrorHandler, source.constData(),
+        source.constData()+source.size(), mContext.getExtensions());
 
     try
     {
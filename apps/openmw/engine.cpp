@@ -3,6 +3,8 @@
 #include <stdexcept>
 #include <iomanip>
 
+#include <boost/filesystem/fstream.hpp>
+
 #include <OgreRoot.h>
 #include <OgreRenderWindow.h>
 
@@ -23,6 +25,7 @@
 #include <components/nifogre/ogrenifloader.hpp>
 
 #include <components/esm/loadcell.hpp>
+#include <components/misc/profiler.hpp>
 
 #include "mwinput/inputmanagerimp.hpp"
 
@@ -31,6 +34,7 @@
 #include "mwscript/scriptmanagerimp.hpp"
 #include "mwscript/extensions.hpp"
 #include "mwscript/interpretercontext.hpp"
+#include "mwscript/scriptprofiler.hpp"
 
 #include "mwsound/soundmanagerimp.hpp"
 
@@ -52,15 +56,25 @@ void OMW::Engine::executeLocalScripts()
 {
     MWWorld::LocalScripts& localScripts = MWBase::Environment::get().getWorld()->getLocalScripts();
 
-    localScripts.startIteration();
+    localScripts.startIteration (mEnvironment.getFrameDuration());
+
+    Ogre::Timer timer;
 
     while (!localScripts.isFinished())
     {
-        std::pair<std::string, MWWorld::Ptr> script = localScripts.getNext();
+        // remaining scripts are run first in the next frame
+        if (mLocalScriptsBudget>0 && timer.getMicroseconds()>=mLocalScriptsBudget)
+            break;
+
+        const MWWorld::LocalScripts::Script& script = localScripts.getNext();
+
+        // the script may add local scripts, which invalidates the reference
+        int handle = script.mHandle;
 
         MWScript::InterpreterContext interpreterContext (
-            &script.second.getRefData().getLocals(), script.second);
-        MWBase::Environment::get().getScriptManager()->run (script.first, interpreterContext);
+            &script.mPtr.getRefData().getLocals(), script.mPtr);
+        interpreterContext.setSecondsPassed (script.mSecondsPassed);
+        MWBase::Environment::get().getScriptManager()->run (handle, interpreterContext);
     }
 
     localScripts.setIgnore (MWWorld::Ptr());
@@ -86,16 +100,23 @@ bool OMW::Engine::frameRenderingQueued (const Ogre::FrameEvent& evt)
         mEnvironment.setFrameDuration (frametime);
 
         // update input
-        MWBase::Environment::get().getInputManager()->update(frametime, false);
+        {
+            Misc::ProfileZone zone ("Input");
+            MWBase::Environment::get().getInputManager()->update(frametime, false);
+        }
 
         // When the window is minimized, pause everything. Currently this *has* to be here to work around a MyGUI bug.
         // If we are not currently rendering, then RenderItems will not be reused resulting in a memory leak upon changing widget textures.
-        if (!mOgre->getWindow()->isActive() || !mOgre->getWindow()->isVisible())
+        // A headless run never renders and its window is never visible.
+        if (!mHeadless && (!mOgre->getWindow()->isActive() || !mOgre->getWindow()->isVisible()))
             return true;
 
         // sound
         if (mUseSound)
+        {
+            Misc::ProfileZone zone ("Sound");
             MWBase::Environment::get().getSoundManager()->update(frametime);
+        }
 
         // GUI active? Most game processing will be paused, but scripts still run.
         bool guiActive = MWBase::Environment::get().getWindowManager()->isGuiMode();
@@ -113,6 +134,8 @@ bool OMW::Engine::frameRenderingQueued (const Ogre::FrameEvent& evt)
             {
                 if (MWBase::Environment::get().getWorld()->getScriptsEnabled())
                 {
+                    Misc::ProfileZone zone ("Scripts");
+
                     // local scripts
                     executeLocalScripts();
 
@@ -133,6 +156,7 @@ bool OMW::Engine::frameRenderingQueued (const Ogre::FrameEvent& evt)
         if (MWBase::Environment::get().getStateManager()->getState()!=
             MWBase::StateManager::State_NoGame)
         {
+            Misc::ProfileZone zone ("Mechanics");
             MWBase::Environment::get().getMechanicsManager()->update(frametime,
                 guiActive);
         }
@@ -149,10 +173,12 @@ bool OMW::Engine::frameRenderingQueued (const Ogre::FrameEvent& evt)
         if (MWBase::Environment::get().getStateManager()->getState()!=
             MWBase::StateManager::State_NoGame)
         {
+            Misc::ProfileZone zone ("World");
             MWBase::Environment::get().getWorld()->update(frametime, guiActive);
         }
 
         // update GUI
+        Misc::ProfileZone zone ("GUI");
         MWBase::Environment::get().getWindowManager()->onFrame(frametime);
         if (MWBase::Environment::get().getStateManager()->getState()!=
             MWBase::StateManager::State_NoGame)
@@ -190,7 +216,12 @@ OMW::Engine::Engine(Files::ConfigurationManager& configurationManager)
   , mScriptContext (0)
   , mFSStrict (false)
   , mScriptBlacklistUse (true)
+  , mScriptProfiling (false)
+  , mLocalScriptsBudget (0)
   , mNewGame (false)
+  , mHeadless (false)
+  , mFrameLimit (0)
+  , mTimestep (0)
   , mCfgMgr(configurationManager)
 {
     OEngine::Misc::Rng::init();
@@ -350,6 +381,7 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     OEngine::Render::WindowSettings windowSettings;
     windowSettings.fullscreen = settings.getBool("fullscreen", "Video");
     windowSettings.window_border = settings.getBool("window border", "Video");
+    windowSettings.hidden = mHeadless;
     windowSettings.window_x = settings.getInt("resolution x", "Video");
     windowSettings.window_y = settings.getInt("resolution y", "Video");
     windowSettings.screen = settings.getInt("screen", "Video");
@@ -399,7 +431,7 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     mEnvironment.setWindowManager (window);
 
     // Create sound system
-    mEnvironment.setSoundManager (new MWSound::SoundManager(mUseSound));
+    mEnvironment.setSoundManager (new MWSound::SoundManager(mUseSound, mCfgMgr.getCachePath().string()));
 
     mOgre->setWindowGammaContrast(Settings::Manager::getFloat("gamma", "General"), Settings::Manager::getFloat("contrast", "General"));
 
@@ -434,6 +466,9 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     mEnvironment.setScriptManager (new MWScript::ScriptManager (MWBase::Environment::get().getWorld()->getStore(),
         mVerboseScripts, *mScriptContext, mWarningsMode,
         mScriptBlacklistUse ? mScriptBlacklist : std::vector<std::string>()));
+    MWBase::Environment::get().getScriptManager()->getProfiler().setEnabled (mScriptProfiling);
+    mLocalScriptsBudget = static_cast<unsigned long> (
+        std::max (0.f, Settings::Manager::getFloat ("local scripts budget", "Game")) * 1000);
 
     // Create game mechanics system
     MWMechanics::MechanicsManager* mechanics = new MWMechanics::MechanicsManager;
@@ -484,7 +519,14 @@ void OMW::Engine::go()
     ToUTF8::Utf8Encoder encoder (mEncoding);
     mEncoder = &encoder;
 
-    prepareEngine (settings);
+    if (!mTraceFile.empty())
+        Misc::Profiler::start (mTraceFile);
+
+    {
+        Misc::ProfileZone zone ("Startup");
+        prepareEngine (settings);
+    }
+    Misc::Profiler::endFrame();
 
     // Play some good 'ol tunes
     MWBase::Environment::get().getSoundManager()->playPlaylist(std::string("Explore"));
@@ -515,20 +557,73 @@ void OMW::Engine::go()
 
     // Start the main rendering loop
     Ogre::Timer timer;
+    Ogre::Timer runTimer;
+    unsigned int frames = 0;
     while (!MWBase::Environment::get().getStateManager()->hasQuitRequest())
     {
         float dt = timer.getMilliseconds()/1000.f;
         dt = std::min(dt, 0.2f);
 
+        if (mTimestep>0)
+            dt = mTimestep;
+
         timer.reset();
-        Ogre::Root::getSingleton().renderOneFrame(dt);
+        {
+            Misc::ProfileZone zone ("Frame");
+            if (mHeadless)
+                simulateFrame(dt);
+            else
+                Ogre::Root::getSingleton().renderOneFrame(dt);
+        }
+        Misc::Profiler::endFrame();
+
+        if (mFrameLimit && ++frames>=mFrameLimit)
+            break;
+    }
+
+    if (mFrameLimit)
+    {
+        unsigned long elapsed = runTimer.getMicroseconds();
+        std::cout
+            << "Ran " << frames << " frames in " << elapsed/1000000.0 << "s ("
+            << elapsed/1000.0/std::max(frames, 1u) << "ms per frame)" << std::endl;
+    }
+
+    if (!mTraceFile.empty())
+    {
+        Misc::Profiler::stop();
+        std::cout << "Frame trace written to " << mTraceFile << std::endl;
     }
+
     // Save user settings
     settings.saveUser(settingspath);
 
+    const MWScript::ScriptProfiler& profiler =
+        MWBase::Environment::get().getScriptManager()->getProfiler();
+
+    if (!profiler.isEmpty())
+    {
+        boost::filesystem::path profilePath = mCfgMgr.getLogPath() / "scriptprofile.txt";
+        boost::filesystem::ofstream stream (profilePath);
+        profiler.write (stream);
+        std::cout << "Script profile written to " << profilePath.string() << std::endl;
+    }
+
     std::cout << "Quitting peacefully." << std::endl;
 }
 
+void OMW::Engine::simulateFrame (float dt)
+{
+    Ogre::FrameEvent evt;
+    evt.timeSinceLastEvent = dt;
+    evt.timeSinceLastFrame = dt;
+
+    Ogre::Root& root = Ogre::Root::getSingleton();
+    root._fireFrameStarted (evt);
+    root._fireFrameRenderingQueued (evt);
+    root._fireFrameEnded (evt);
+}
+
 void OMW::Engine::activate()
 {
     if (MWBase::Environment::get().getWindowManager()->isGuiMode())
@@ -595,6 +690,31 @@ void OMW::Engine::setSoundUsage(bool soundUsage)
     mUseSound = soundUsage;
 }
 
+void OMW::Engine::setHeadless (bool headless)
+{
+    mHeadless = headless;
+}
+
+void OMW::Engine::setFrameLimit (unsigned int frames)
+{
+    mFrameLimit = frames;
+}
+
+void OMW::Engine::setTimestep (float timestep)
+{
+    mTimestep = timestep;
+}
+
+void OMW::Engine::setRandomSeed (unsigned int seed)
+{
+    OEngine::Misc::Rng::init (seed);
+}
+
+void OMW::Engine::setTraceFile (const std::string& path)
+{
+    mTraceFile = path;
+}
+
 void OMW::Engine::setEncoding(const ToUTF8::FromType& encoding)
 {
     mEncoding = encoding;
@@ -635,6 +755,11 @@ void OMW::Engine::setScriptBlacklistUse (bool use)
     mScriptBlacklistUse = use;
 }
 
+void OMW::Engine::setScriptProfiling (bool enabled)
+{
+    mScriptProfiling = enabled;
+}
+
 void OMW::Engine::enableFontExport(bool exportFonts)
 {
     mExportFonts = exportFonts;
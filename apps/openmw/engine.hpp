@@ -96,7 +96,13 @@ namespace OMW
             Translation::Storage mTranslationDataStorage;
             std::vector<std::string> mScriptBlacklist;
             bool mScriptBlacklistUse;
+            bool mScriptProfiling;
+            unsigned long mLocalScriptsBudget; // microseconds per frame, 0: unlimited
             bool mNewGame;
+            bool mHeadless;
+            unsigned int mFrameLimit; // 0: unlimited
+            float mTimestep; // seconds, 0: real time
+            std::string mTraceFile;
 
             Nif::Cache mNifCache;
 
@@ -113,6 +119,9 @@ namespace OMW
 
             void executeLocalScripts();
 
+            /// Run the frame listeners for one frame without rendering it.
+            void simulateFrame (float dt);
+
             virtual bool frameRenderingQueued (const Ogre::FrameEvent& evt);
             virtual bool frameStarted (const Ogre::FrameEvent& evt);
 
@@ -164,6 +173,22 @@ namespace OMW
 
             void setGrabMouse(bool grab) { mGrab = grab; }
 
+            /// Run the simulation in a hidden window, without sound and without rendering frames.
+            void setHeadless (bool headless);
+
+            /// Quit after the given number of frames (0: run until quit is requested).
+            void setFrameLimit (unsigned int frames);
+
+            /// Advance the simulation by a fixed time per frame instead of the measured frame time
+            /// (0: use the measured frame time).
+            void setTimestep (float timestep);
+
+            /// Seed the random number generator with a fixed value.
+            void setRandomSeed (unsigned int seed);
+
+            /// Write the frame timings to \a path (empty: do not write a trace).
+            void setTraceFile (const std::string& path);
+
             /// Initialise and enter main loop.
             void go();
 
@@ -199,6 +224,9 @@ namespace OMW
 
             void setScriptBlacklistUse (bool use);
 
+            /// Collect script execution statistics from startup on
+            void setScriptProfiling (bool enabled);
+
             void enableFontExport(bool exportFonts);
 
             /// Set the save game file to load after initialising the engine.
@@ -152,6 +152,9 @@ bool parseOptions (int argc, char** argv, OMW::Engine& engine, Files::Configurat
         ("script-blacklist-use", bpo::value<bool>()->implicit_value(true)
             ->default_value(true), "enable script blacklisting")
 
+        ("script-profile", bpo::value<bool>()->implicit_value(true)
+            ->default_value(false), "collect script execution statistics from startup on (written to scriptprofile.txt on exit)")
+
         ("load-savegame", bpo::value<std::string>()->default_value(""),
             "load a save game file on game startup (specify an absolute filename or a filename relative to the current working directory)")
 
@@ -161,6 +164,21 @@ bool parseOptions (int argc, char** argv, OMW::Engine& engine, Files::Configurat
         ("new-game", bpo::value<bool>()->implicit_value(true)
             ->default_value(false), "run new game sequence (ignored if skip-menu=0)")
 
+        ("headless", bpo::value<bool>()->implicit_value(true)
+            ->default_value(false), "run the simulation without rendering, sound or menus (implies skip-menu and no-sound)")
+
+        ("frames", bpo::value<unsigned int>()->default_value(0),
+            "quit after the given number of frames (0: unlimited)")
+
+        ("timestep", bpo::value<float>()->default_value(0.0f),
+            "advance the simulation by a fixed number of seconds per frame (0: real time, 1/60 in headless mode)")
+
+        ("seed", bpo::value<int>()->default_value(-1),
+            "seed for the random number generator (-1: random)")
+
+        ("trace-file", bpo::value<std::string>()->default_value(""),
+            "write per-frame timings of the main subsystems to a file in the Chrome trace event format")
+
         ("fs-strict", bpo::value<bool>()->implicit_value(true)
             ->default_value(false), "strict file system handling (no case folding)")
 
@@ -271,10 +289,30 @@ bool parseOptions (int argc, char** argv, OMW::Engine& engine, Files::Configurat
     engine.setWarningsMode (variables["script-warn"].as<int>());
     engine.setScriptBlacklist (variables["script-blacklist"].as<StringsVector>());
     engine.setScriptBlacklistUse (variables["script-blacklist-use"].as<bool>());
+    engine.setScriptProfiling (variables["script-profile"].as<bool>());
     engine.setSaveGameFile (variables["load-savegame"].as<std::string>());
 
     // other settings
     engine.setSoundUsage(!variables["no-sound"].as<bool>());
+
+    // headless simulation
+    bool headless = variables["headless"].as<bool>();
+    float timestep = variables["timestep"].as<float>();
+    engine.setHeadless (headless);
+    if (headless)
+    {
+        engine.setSoundUsage (false);
+        engine.setGrabMouse (false);
+        if (variables["load-savegame"].as<std::string>().empty())
+            engine.setSkipMenu (true, variables["new-game"].as<bool>());
+        if (timestep<=0)
+            timestep = 1.0f/60;
+    }
+    engine.setTimestep (timestep);
+    engine.setFrameLimit (variables["frames"].as<unsigned int>());
+    if (variables["seed"].as<int>()>=0)
+        engine.setRandomSeed (static_cast<unsigned int> (variables["seed"].as<int>()));
+    engine.setTraceFile (variables["trace-file"].as<std::string>());
     engine.setFallbackValues(variables["fallback"].as<FallbackMap>().mMap);
     engine.setActivationDistanceOverride (variables["activate-dist"].as<int>());
     engine.enableFontExport(variables["export-fonts"].as<bool>());
@@ -16,6 +16,8 @@ namespace Compiler
 namespace MWScript
 {
     class GlobalScripts;
+    class MemberCache;
+    class ScriptProfiler;
 }
 
 namespace MWBase
@@ -38,6 +40,16 @@ namespace MWBase
             virtual void run (const std::string& name, Interpreter::Context& interpreterContext) = 0;
             ///< Run the script with the given name (compile first, if not compiled yet)
 
+            virtual int getHandle (const std::string& name) = 0;
+            ///< Return a handle that can be used to run the script with the given name without
+            /// looking it up again (compile first, if not compiled yet).
+
+            virtual void run (int handle, Interpreter::Context& interpreterContext) = 0;
+            ///< Run the script with the given handle.
+
+            virtual bool isActivationOnly (int handle) const = 0;
+            ///< Can the script only have an effect, when it is run on activation of its reference?
+
             virtual bool compile (const std::string& name) = 0;
             ///< Compile script with the given namen
             /// \return Success?
@@ -50,6 +62,11 @@ namespace MWBase
             ///< Return locals for script \a name.
 
             virtual MWScript::GlobalScripts& getGlobalScripts() = 0;
+
+            virtual MWScript::MemberCache& getMemberCache() = 0;
+            ///< Return resolved targets of member variable accesses.
+
+            virtual MWScript::ScriptProfiler& getProfiler() = 0;
    };
 }
 
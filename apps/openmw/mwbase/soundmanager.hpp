@@ -72,8 +72,6 @@ namespace MWBase
 
             virtual ~SoundManager() {}
 
-            virtual void processChangedSettings(const std::set< std::pair<std::string, std::string> >& settings) = 0;
-
             virtual void stopMusic() = 0;
             ///< Stops music if it's playing
 
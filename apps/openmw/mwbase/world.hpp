@@ -192,6 +192,11 @@ namespace MWBase
             ///< Return a pointer to a liveCellRef with the given name.
             /// \param activeOnly do non search inactive cells.
 
+            virtual unsigned int getReferenceGeneration() const = 0;
+            ///< Return a counter that changes whenever a Ptr returned by getPtr or searchPtr
+            /// may have become invalid (reference moved to another cell or deleted, cell loaded
+            /// or unloaded).
+
             virtual MWWorld::Ptr getPtrViaHandle (const std::string& handle) = 0;
             ///< Return a pointer to a liveCellRef with the given Ogre handle.
 
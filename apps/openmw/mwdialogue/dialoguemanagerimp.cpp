@@ -190,9 +190,10 @@ namespace MWDialogue
         {
             mErrorHandler.reset();
 
-            std::istringstream input (cmd + "\n");
+            std::string source = cmd + "\n";
 
-            Compiler::Scanner scanner (mErrorHandler, input, mCompilerContext.getExtensions());
+            Compiler::Scanner scanner (mErrorHandler, source.data(), source.data()+source.size(),
+                mCompilerContext.getExtensions());
 
             Compiler::Locals locals;
 
@@ -50,9 +50,10 @@ void test(const MWWorld::Ptr& actor, int &compiled, int &total, const Compiler::
                 {
                     errorHandler.reset();
 
-                    std::istringstream input (info->mResultScript + "\n");
+                    std::string source = info->mResultScript + "\n";
 
-                    Compiler::Scanner scanner (errorHandler, input, extensions);
+                    Compiler::Scanner scanner (errorHandler, source.data(),
+                        source.data()+source.size(), extensions);
 
                     Compiler::Locals locals;
 
@@ -6,6 +6,8 @@
 #include "MyGUI_TextureUtility.h"
 #include "MyGUI_FactoryManager.h"
 
+#include <algorithm>
+#include <map>
 #include <stdint.h>
 #include <boost/function.hpp>
 #include <boost/shared_ptr.hpp>
@@ -25,6 +27,59 @@ static bool ucsBreakingSpace (int codePoint);
 
 struct BookTypesetter::Style { virtual ~Style () {} };
 
+/// Layout widths of the characters of a font. Looking up a glyph in a MyGUI font is a map
+/// search; the widths of the first 256 code points are remembered instead.
+class GlyphWidths
+{
+    MyGUI::IFont* mFont;
+    int mWidths [256]; // -1: not looked up yet
+
+    GlyphWidths (MyGUI::IFont* font) : mFont (font)
+    {
+        std::fill (mWidths, mWidths + 256, -1);
+    }
+
+    int lookup (Utf8Stream::UnicodeChar codePoint) const
+    {
+        MyGUI::GlyphInfo* gi = mFont->getGlyphInfo (codePoint);
+        return gi ? static_cast<int>(gi->advance + gi->bearingX) : 0;
+    }
+
+public:
+
+    static GlyphWidths* get (MyGUI::IFont* font)
+    {
+        static std::map <MyGUI::IFont*, GlyphWidths> widths;
+
+        std::map <MyGUI::IFont*, GlyphWidths>::iterator i = widths.find (font);
+
+        if (i == widths.end ())
+            i = widths.insert (std::make_pair (font, GlyphWidths (font))).first;
+
+        return &i->second;
+    }
+
+    int width (Utf8Stream::UnicodeChar codePoint)
+    {
+        if (codePoint >= 256)
+            return lookup (codePoint);
+
+        int & width = mWidths [codePoint];
+
+        if (width < 0)
+            width = lookup (codePoint);
+
+        return width;
+    }
+};
+
+// Sections and the lines within a section are sorted from top to bottom without overlapping.
+template <typename T>
+static bool isAbove (T const & item, int top)
+{
+    return item.mRect.bottom <= top;
+}
+
 struct TypesetBookImpl : TypesetBook
 {
     typedef std::vector <uint8_t> Content;
@@ -35,6 +90,7 @@ struct TypesetBookImpl : TypesetBook
     struct StyleImpl : BookTypesetter::Style
     {
         MyGUI::IFont*         mFont;
+        GlyphWidths*          mGlyphWidths;
         MyGUI::Colour         mHotColour;
         MyGUI::Colour         mActiveColour;
         MyGUI::Colour         mNormalColour;
@@ -130,16 +186,12 @@ struct TypesetBookImpl : TypesetBook
     template <typename Visitor>
     void visitRuns (int top, int bottom, MyGUI::IFont* Font, Visitor const & visitor) const
     {
-        for (Sections::const_iterator i = mSections.begin (); i != mSections.end (); ++i)
+        for (Sections::const_iterator i = std::lower_bound (mSections.begin (), mSections.end (), top, isAbove <Section>);
+             i != mSections.end () && i->mRect.top < bottom; ++i)
         {
-            if (top >= mRect.bottom || bottom <= i->mRect.top)
-                continue;
-
-            for (Lines::const_iterator j = i->mLines.begin (); j != i->mLines.end (); ++j)
+            for (Lines::const_iterator j = std::lower_bound (i->mLines.begin (), i->mLines.end (), top, isAbove <Line>);
+                 j != i->mLines.end () && j->mRect.top < bottom; ++j)
             {
-                if (top >= j->mRect.bottom || bottom <= j->mRect.top)
-                    continue;
-
                 for (Runs::const_iterator k = j->mRuns.begin (); k != j->mRuns.end (); ++k)
                     if (!Font || k->mStyle->mFont == Font)
                         visitor (*i, *j, *k);
@@ -155,28 +207,26 @@ struct TypesetBookImpl : TypesetBook
 
     StyleImpl * hitTest (int left, int top) const
     {
-        for (Sections::const_iterator i = mSections.begin (); i != mSections.end (); ++i)
-        {
-            if (top < i->mRect.top || top >= i->mRect.bottom)
-                continue;
+        Sections::const_iterator i = std::lower_bound (mSections.begin (), mSections.end (), top, isAbove <Section>);
 
-            int left1 = left - i->mRect.left;
+        if (i == mSections.end () || top < i->mRect.top)
+            return nullptr;
 
-            for (Lines::const_iterator j = i->mLines.begin (); j != i->mLines.end (); ++j)
-            {
-                if (top < j->mRect.top || top >= j->mRect.bottom)
-                    continue;
+        int left1 = left - i->mRect.left;
 
-                int left2 = left1 - j->mRect.left;
+        Lines::const_iterator j = std::lower_bound (i->mLines.begin (), i->mLines.end (), top, isAbove <Line>);
 
-                for (Runs::const_iterator k = j->mRuns.begin (); k != j->mRuns.end (); ++k)
-                {
-                    if (left2 < k->mLeft || left2 >= k->mRight)
-                        continue;
+        if (j == i->mLines.end () || top < j->mRect.top)
+            return nullptr;
 
-                    return k->mStyle;
-                }
-            }
+        int left2 = left1 - j->mRect.left;
+
+        for (Runs::const_iterator k = j->mRuns.begin (); k != j->mRuns.end (); ++k)
+        {
+            if (left2 < k->mLeft || left2 >= k->mRight)
+                continue;
+
+            return k->mStyle;
         }
 
         return nullptr;
@@ -250,6 +300,7 @@ struct TypesetBookImpl::Typesetter : BookTypesetter
         StyleImpl & style = *mBook->mStyles.insert (mBook->mStyles.end (), StyleImpl ());
 
         style.mFont = MyGUI::FontManager::getInstance().getByName(fontName);
+        style.mGlyphWidths = GlyphWidths::get (style.mFont);
         style.mHotColour = fontColour;
         style.mActiveColour = fontColour;
         style.mNormalColour = fontColour;
@@ -270,6 +321,7 @@ struct TypesetBookImpl::Typesetter : BookTypesetter
         StyleImpl & style = *mBook->mStyles.insert (mBook->mStyles.end (), StyleImpl ());
 
         style.mFont = BaseStyle->mFont;
+        style.mGlyphWidths = BaseStyle->mGlyphWidths;
         style.mHotColour = hoverColour;
         style.mActiveColour = activeColour;
         style.mNormalColour = normalColour;
@@ -463,9 +515,7 @@ struct TypesetBookImpl::Typesetter : BookTypesetter
 
             while (!stream.eof () && !ucsLineBreak (stream.peek ()) && ucsBreakingSpace (stream.peek ()))
             {
-                MyGUI::GlyphInfo* gi = style->mFont->getGlyphInfo (stream.peek ());
-                if (gi)
-                    space_width += static_cast<int>(gi->advance + gi->bearingX);
+                space_width += style->mGlyphWidths->width (stream.peek ());
                 stream.consume ();
             }
 
@@ -473,9 +523,7 @@ struct TypesetBookImpl::Typesetter : BookTypesetter
 
             while (!stream.eof () && !ucsLineBreak (stream.peek ()) && !ucsBreakingSpace (stream.peek ()))
             {
-                MyGUI::GlyphInfo* gi = style->mFont->getGlyphInfo (stream.peek ());
-                if (gi)
-                    word_width += static_cast<int>(gi->advance + gi->bearingX);
+                word_width += style->mGlyphWidths->width (stream.peek ());
                 stream.consume ();
             }
 
@@ -892,7 +940,7 @@ public:
 
             ActiveTextFormats::iterator i = mActiveTextFormats.find (Font);
 
-            if (mNode)
+            if (mNode && i != mActiveTextFormats.end ())
                 mNode->outOfDate (i->second->mRenderItem);
         }
     }
@@ -997,32 +1045,11 @@ public:
             mFocusItem = nullptr;
             mItemActive = 0;
 
-            for (ActiveTextFormats::iterator i = mActiveTextFormats.begin (); i != mActiveTextFormats.end (); ++i)
-            {
-                if (mNode != NULL)
-                    i->second->destroyDrawItem (mNode);
-                delete i->second;
-            }
-
-            mActiveTextFormats.clear ();
-
             if (newBook != NULL)
             {
-                createActiveFormats (newBook);
-
                 mBook = newBook;
                 setPage (newPage);
-
-                if (newPage < mBook->mPages.size ())
-                {
-                    mViewTop = mBook->mPages [newPage].first;
-                    mViewBottom = mBook->mPages [newPage].second;
-                }
-                else
-                {
-                    mViewTop = 0;
-                    mViewBottom = 0;
-                }
+                setViewRange (newPage);
             }
             else
             {
@@ -1031,26 +1058,30 @@ public:
                 mViewTop = 0;
                 mViewBottom = 0;
             }
+
+            createActiveFormats ();
         }
         else
         if (mBook && isPageDifferent (newPage))
         {
-            if (mNode != NULL)
-                for (ActiveTextFormats::iterator i = mActiveTextFormats.begin (); i != mActiveTextFormats.end (); ++i)
-                    mNode->outOfDate(i->second->mRenderItem);
-
             setPage (newPage);
+            setViewRange (newPage);
 
-            if (newPage < mBook->mPages.size ())
-            {
-                mViewTop = mBook->mPages [newPage].first;
-                mViewBottom = mBook->mPages [newPage].second;
-            }
-            else
-            {
-                mViewTop = 0;
-                mViewBottom = 0;
-            }
+            createActiveFormats ();
+        }
+    }
+
+    void setViewRange (size_t page)
+    {
+        if (page < mBook->mPages.size ())
+        {
+            mViewTop = mBook->mPages [page].first;
+            mViewBottom = mBook->mPages [page].second;
+        }
+        else
+        {
+            mViewTop = 0;
+            mViewBottom = 0;
         }
     }
 
@@ -1079,9 +1110,23 @@ public:
         }
     };
 
-    void createActiveFormats (boost::shared_ptr <TypesetBookImpl> newBook)
+    /*
+        only the runs of the page on display get vertices, so the cost of
+        showing a page does not depend on the length of the book
+    */
+    void createActiveFormats ()
     {
-        newBook->visitRuns (0, 0x7FFFFFFF, CreateActiveFormat (this));
+        for (ActiveTextFormats::iterator i = mActiveTextFormats.begin (); i != mActiveTextFormats.end (); ++i)
+        {
+            if (mNode != NULL)
+                i->second->destroyDrawItem (mNode);
+            delete i->second;
+        }
+
+        mActiveTextFormats.clear ();
+
+        if (mBook)
+            mBook->visitRuns (mViewTop, mViewBottom, CreateActiveFormat (this));
 
         if (mNode != NULL)
             for (ActiveTextFormats::iterator i = mActiveTextFormats.begin (); i != mActiveTextFormats.end (); ++i)
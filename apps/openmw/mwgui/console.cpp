@@ -47,9 +47,10 @@ namespace MWGui
         {
             ErrorHandler::reset();
 
-            std::istringstream input (cmd + '\n');
+            std::string source = cmd + '\n';
 
-            Compiler::Scanner scanner (*this, input, mCompilerContext.getExtensions());
+            Compiler::Scanner scanner (*this, source.data(), source.data()+source.size(),
+                mCompilerContext.getExtensions());
 
             Compiler::LineParser parser (*this, mCompilerContext, output.getLocals(),
                 output.getLiterals(), output.getCode(), true);
@@ -89,9 +90,7 @@ namespace MWGui
         if (mNames.empty())
         {
             // keywords
-            std::istringstream input ("");
-
-            Compiler::Scanner scanner (*this, input, mCompilerContext.getExtensions());
+            Compiler::Scanner scanner (*this, 0, 0, mCompilerContext.getExtensions());
 
             scanner.listKeywords (mNames);
 
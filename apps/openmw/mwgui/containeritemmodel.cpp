@@ -1,5 +1,9 @@
 #include "containeritemmodel.hpp"
 
+#include <map>
+
+#include <components/misc/stringops.hpp>
+
 #include "../mwworld/containerstore.hpp"
 #include "../mwworld/class.hpp"
 
@@ -28,6 +32,30 @@ namespace
         return store.stacks(left, right);
     }
 
+    /// Stack indices by lower case ID. Items with different IDs never stack, so each item only
+    /// needs to be compared to the stacks that share its ID.
+    typedef std::map<std::string, std::vector<size_t> > StackIndex;
+
+    void addToStacks (const MWWorld::Ptr& item, std::vector<MWGui::ItemStack>& items, StackIndex& index,
+        MWGui::ItemModel* creator)
+    {
+        std::vector<size_t>& candidates = index[Misc::StringUtils::lowerCase(item.getCellRef().getRefId())];
+
+        for (std::vector<size_t>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+        {
+            if (stacks(item, items[*it].mBase))
+            {
+                // we already have an item stack of this kind, add to it
+                items[*it].mCount += item.getRefData().getCount();
+                return;
+            }
+        }
+
+        // no stack yet, create one
+        candidates.push_back(items.size());
+        items.push_back(MWGui::ItemStack(item, creator, item.getRefData().getCount()));
+    }
+
 }
 
 namespace MWGui
@@ -118,51 +146,17 @@ void ContainerItemModel::removeItem (const ItemStack& item, size_t count)
 void ContainerItemModel::update()
 {
     mItems.clear();
+    StackIndex index;
+
     for (std::vector<MWWorld::Ptr>::iterator source = mItemSources.begin(); source != mItemSources.end(); ++source)
     {
         MWWorld::ContainerStore& store = source->getClass().getContainerStore(*source);
 
         for (MWWorld::ContainerStoreIterator it = store.begin(); it != store.end(); ++it)
-        {
-            std::vector<ItemStack>::iterator itemStack = mItems.begin();
-            for (; itemStack != mItems.end(); ++itemStack)
-            {
-                if (stacks(*it, itemStack->mBase))
-                {
-                    // we already have an item stack of this kind, add to it
-                    itemStack->mCount += it->getRefData().getCount();
-                    break;
-                }
-            }
-
-            if (itemStack == mItems.end())
-            {
-                // no stack yet, create one
-                ItemStack newItem (*it, this, it->getRefData().getCount());
-                mItems.push_back(newItem);
-            }
-        }
+            addToStacks(*it, mItems, index, this);
     }
     for (std::vector<MWWorld::Ptr>::iterator source = mWorldItems.begin(); source != mWorldItems.end(); ++source)
-    {
-        std::vector<ItemStack>::iterator itemStack = mItems.begin();
-        for (; itemStack != mItems.end(); ++itemStack)
-        {
-            if (stacks(*source, itemStack->mBase))
-            {
-                // we already have an item stack of this kind, add to it
-                itemStack->mCount += source->getRefData().getCount();
-                break;
-            }
-        }
-
-        if (itemStack == mItems.end())
-        {
-            // no stack yet, create one
-            ItemStack newItem (*source, this, source->getRefData().getCount());
-            mItems.push_back(newItem);
-        }
-    }
+        addToStacks(*source, mItems, index, this);
 }
 
 }
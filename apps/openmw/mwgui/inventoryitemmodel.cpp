@@ -1,5 +1,7 @@
 #include "inventoryitemmodel.hpp"
 
+#include <set>
+
 #include "../mwworld/containerstore.hpp"
 #include "../mwworld/class.hpp"
 #include "../mwworld/inventorystore.hpp"
@@ -74,6 +76,19 @@ void InventoryItemModel::update()
 {
     MWWorld::ContainerStore& store = mActor.getClass().getContainerStore(mActor);
 
+    // look up the equipment slots once instead of once per item
+    std::set<MWWorld::Ptr> equipped;
+    if (mActor.getClass().hasInventoryStore(mActor))
+    {
+        MWWorld::InventoryStore& invStore = mActor.getClass().getInventoryStore(mActor);
+        for (int slot = 0; slot < MWWorld::InventoryStore::Slots; ++slot)
+        {
+            MWWorld::ContainerStoreIterator equippedItem = invStore.getSlot(slot);
+            if (equippedItem != invStore.end())
+                equipped.insert(*equippedItem);
+        }
+    }
+
     mItems.clear();
 
     for (MWWorld::ContainerStoreIterator it = store.begin(); it != store.end(); ++it)
@@ -87,12 +102,8 @@ void InventoryItemModel::update()
 
         ItemStack newItem (item, this, item.getRefData().getCount());
 
-        if (mActor.getClass().hasInventoryStore(mActor))
-        {
-            MWWorld::InventoryStore& store = mActor.getClass().getInventoryStore(mActor);
-            if (store.isEquipped(newItem.mBase))
-                newItem.mType = ItemStack::Type_Equipped;
-        }
+        if (equipped.find(item) != equipped.end())
+            newItem.mType = ItemStack::Type_Equipped;
 
         mItems.push_back(newItem);
     }
@@ -2,6 +2,7 @@
 
 #include <map>
 #include <sstream>
+#include <vector>
 #include <boost/make_shared.hpp>
 
 #include <MyGUI_LanguageManager.h>
@@ -29,6 +30,27 @@ struct JournalViewModelImpl : JournalViewModel
     mutable bool             mKeywordSearchLoaded;
     mutable KeywordSearchT mKeywordSearch;
 
+    /// Display text of a journal entry, split into plain text and hyperlinks
+    struct LaidOutEntry
+    {
+        struct Span
+        {
+            TopicId mTopicId;
+            size_t mBegin;
+            size_t mEnd;
+        };
+
+        std::string mText;
+        std::vector<Span> mSpans;
+    };
+
+    typedef std::vector<std::pair<std::string, TopicId> > TopicSignature;
+
+    // Entries keep their text, so their layout is kept between openings of the journal, for as
+    // long as the topics that can be linked to are the same.
+    mutable std::map<std::string, LaidOutEntry> mLaidOutEntries;
+    mutable TopicSignature mLaidOutTopics;
+
     std::locale mLocale;
 
     JournalViewModelImpl ()
@@ -67,13 +89,120 @@ struct JournalViewModelImpl : JournalViewModel
         {
             MWBase::Journal * journal = MWBase::Environment::get().getJournal();
 
+            TopicSignature topics;
+
             for(MWBase::Journal::TTopicIter i = journal->topicBegin(); i != journal->topicEnd (); ++i)
+            {
                 mKeywordSearch.seed (i->first, intptr_t (&i->second));
+                topics.push_back (std::make_pair (i->first, intptr_t (&i->second)));
+            }
+
+            if (topics != mLaidOutTopics)
+            {
+                mLaidOutEntries.clear ();
+                mLaidOutTopics.swap (topics);
+            }
 
             mKeywordSearchLoaded = true;
         }
     }
 
+    void addSpan (LaidOutEntry & entry, TopicId topicId, size_t begin, size_t end) const
+    {
+        LaidOutEntry::Span span;
+        span.mTopicId = topicId;
+        span.mBegin = begin;
+        span.mEnd = end;
+        entry.mSpans.push_back (span);
+    }
+
+    LaidOutEntry const & layOutEntry (std::string const & text) const
+    {
+        ensureKeyWordSearchLoaded ();
+
+        std::map<std::string, LaidOutEntry>::iterator found = mLaidOutEntries.find (text);
+
+        if (found != mLaidOutEntries.end ())
+            return found->second;
+
+        LaidOutEntry & entry = mLaidOutEntries [text];
+
+        std::string & utf8text = entry.mText;
+
+        utf8text = text;
+
+        // hyperlinks in @link# notation
+        typedef std::pair<size_t, size_t> Range;
+        std::map<Range, intptr_t> hyperLinks;
+
+        size_t pos_end = 0;
+        for(;;)
+        {
+            size_t pos_begin = utf8text.find('@');
+            if (pos_begin != std::string::npos)
+                pos_end = utf8text.find('#', pos_begin);
+
+            if (pos_begin != std::string::npos && pos_end != std::string::npos)
+            {
+                std::string link = utf8text.substr(pos_begin + 1, pos_end - pos_begin - 1);
+                const char specialPseudoAsteriskCharacter = 127;
+                std::replace(link.begin(), link.end(), specialPseudoAsteriskCharacter, '*');
+                std::string topicName = MWBase::Environment::get().getWindowManager()->
+                        getTranslationDataStorage().topicStandardForm(link);
+
+                std::string displayName = link;
+                while (displayName[displayName.size()-1] == '*')
+                    displayName.erase(displayName.size()-1, 1);
+
+                utf8text.replace(pos_begin, pos_end+1-pos_begin, displayName);
+
+                intptr_t value;
+                if (mKeywordSearch.containsKeyword(topicName, value))
+                    hyperLinks[std::make_pair(pos_begin, pos_begin+displayName.size())] = value;
+            }
+            else
+                break;
+        }
+
+        if (hyperLinks.size() && MWBase::Environment::get().getWindowManager()->getTranslationDataStorage().hasTranslation())
+        {
+            size_t formatted = 0; // points to the first character that is not laid out yet
+            for (std::map<Range, intptr_t>::const_iterator it = hyperLinks.begin(); it != hyperLinks.end(); ++it)
+            {
+                intptr_t topicId = it->second;
+                if (formatted < it->first.first)
+                    addSpan (entry, 0, formatted, it->first.first);
+                addSpan (entry, topicId, it->first.first, it->first.second);
+                formatted = it->first.second;
+            }
+            if (formatted < utf8text.size())
+                addSpan (entry, 0, formatted, utf8text.size());
+        }
+        else
+        {
+            std::vector<KeywordSearchT::Match> matches;
+            mKeywordSearch.highlightKeywords(utf8text.begin(), utf8text.end(), matches);
+
+            std::string::const_iterator i = utf8text.begin ();
+            for (std::vector<KeywordSearchT::Match>::const_iterator it = matches.begin(); it != matches.end(); ++it)
+            {
+                const KeywordSearchT::Match& match = *it;
+
+                if (i != match.mBeg)
+                    addSpan (entry, 0, i - utf8text.begin (), match.mBeg - utf8text.begin ());
+
+                addSpan (entry, match.mValue, match.mBeg - utf8text.begin (), match.mEnd - utf8text.begin ());
+
+                i = match.mEnd;
+            }
+
+            if (i != utf8text.end ())
+                addSpan (entry, 0, i - utf8text.begin (), utf8text.size ());
+        }
+
+        return entry;
+    }
+
     wchar_t tolower (wchar_t ch) const { return std::tolower (ch, mLocale); }
 
     bool isEmpty () const
@@ -92,109 +221,34 @@ struct JournalViewModelImpl : JournalViewModel
         JournalViewModelImpl const *    mModel;
 
         BaseEntry (JournalViewModelImpl const * model, iterator_t itr) :
-            mModel (model), itr (itr), loaded (false)
+            mModel (model), itr (itr), mLaidOut (NULL)
         {}
 
         virtual ~BaseEntry () {}
 
-        mutable bool loaded;
-        mutable std::string utf8text;
-
-        typedef std::pair<size_t, size_t> Range;
-
-        // hyperlinks in @link# notation
-        mutable std::map<Range, intptr_t> mHyperLinks;
+        mutable LaidOutEntry const * mLaidOut;
 
         virtual std::string getText () const = 0;
 
         void ensureLoaded () const
         {
-            if (!loaded)
-            {
-                mModel->ensureKeyWordSearchLoaded ();
-
-                utf8text = getText ();
-
-                size_t pos_end = 0;
-                for(;;)
-                {
-                    size_t pos_begin = utf8text.find('@');
-                    if (pos_begin != std::string::npos)
-                        pos_end = utf8text.find('#', pos_begin);
-
-                    if (pos_begin != std::string::npos && pos_end != std::string::npos)
-                    {
-                        std::string link = utf8text.substr(pos_begin + 1, pos_end - pos_begin - 1);
-                        const char specialPseudoAsteriskCharacter = 127;
-                        std::replace(link.begin(), link.end(), specialPseudoAsteriskCharacter, '*');
-                        std::string topicName = MWBase::Environment::get().getWindowManager()->
-                                getTranslationDataStorage().topicStandardForm(link);
-
-                        std::string displayName = link;
-                        while (displayName[displayName.size()-1] == '*')
-                            displayName.erase(displayName.size()-1, 1);
-
-                        utf8text.replace(pos_begin, pos_end+1-pos_begin, displayName);
-
-                        intptr_t value;
-                        if (mModel->mKeywordSearch.containsKeyword(topicName, value))
-                            mHyperLinks[std::make_pair(pos_begin, pos_begin+displayName.size())] = value;
-                    }
-                    else
-                        break;
-                }
-
-                loaded = true;
-            }
+            if (!mLaidOut)
+                mLaidOut = &mModel->layOutEntry (getText ());
         }
 
         Utf8Span body () const
         {
             ensureLoaded ();
 
-            return toUtf8Span (utf8text);
+            return toUtf8Span (mLaidOut->mText);
         }
 
         void visitSpans (boost::function < void (TopicId, size_t, size_t)> visitor) const
         {
             ensureLoaded ();
-            mModel->ensureKeyWordSearchLoaded ();
 
-            if (mHyperLinks.size() && MWBase::Environment::get().getWindowManager()->getTranslationDataStorage().hasTranslation())
-            {
-                size_t formatted = 0; // points to the first character that is not laid out yet
-                for (std::map<Range, intptr_t>::const_iterator it = mHyperLinks.begin(); it != mHyperLinks.end(); ++it)
-                {
-                    intptr_t topicId = it->second;
-                    if (formatted < it->first.first)
-                        visitor (0, formatted, it->first.first);
-                    visitor (topicId, it->first.first, it->first.second);
-                    formatted = it->first.second;
-                }
-                if (formatted < utf8text.size())
-                    visitor (0, formatted, utf8text.size());
-            }
-            else
-            {
-                std::vector<KeywordSearchT::Match> matches;
-                mModel->mKeywordSearch.highlightKeywords(utf8text.begin(), utf8text.end(), matches);
-
-                std::string::const_iterator i = utf8text.begin ();
-                for (std::vector<KeywordSearchT::Match>::const_iterator it = matches.begin(); it != matches.end(); ++it)
-                {
-                    const KeywordSearchT::Match& match = *it;
-
-                    if (i != match.mBeg)
-                        visitor (0, i - utf8text.begin (), match.mBeg - utf8text.begin ());
-
-                    visitor (match.mValue, match.mBeg - utf8text.begin (), match.mEnd - utf8text.begin ());
-
-                    i = match.mEnd;
-                }
-
-                if (i != utf8text.end ())
-                    visitor (0, i - utf8text.begin (), utf8text.size ());
-            }
+            for (std::vector<LaidOutEntry::Span>::const_iterator it = mLaidOut->mSpans.begin(); it != mLaidOut->mSpans.end(); ++it)
+                visitor (it->mTopicId, it->mBegin, it->mEnd);
         }
 
     };
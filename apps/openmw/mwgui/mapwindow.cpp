@@ -560,6 +560,7 @@ namespace MWGui
         , mEventBoxLocal(NULL)
         , mGlobalMapImage(NULL)
         , mGlobalMapOverlay(NULL)
+        , mCacheDir(cacheDir)
     {
         static bool registered = false;
         if (!registered)
@@ -701,7 +702,7 @@ namespace MWGui
 
     void MapWindow::renderGlobalMap(Loading::Listener* loadingListener)
     {
-        mGlobalMapRender = new MWRender::GlobalMap("");
+        mGlobalMapRender = new MWRender::GlobalMap(mCacheDir);
         mGlobalMapRender->render(loadingListener);
         mGlobalMap->setCanvasSize (mGlobalMapRender->getWidth(), mGlobalMapRender->getHeight());
         mGlobalMapImage->setSize(mGlobalMapRender->getWidth(), mGlobalMapRender->getHeight());
@@ -221,6 +221,8 @@ namespace MWGui
         EditNoteDialog mEditNoteDialog;
         ESM::CustomMarker mEditingMarker;
 
+        std::string mCacheDir;
+
         virtual void onPinToggled();
         virtual void onTitleDoubleClicked();
 
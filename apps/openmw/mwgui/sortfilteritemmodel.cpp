@@ -1,5 +1,7 @@
 #include "sortfilteritemmodel.hpp"
 
+#include <map>
+
 #include <components/misc/stringops.hpp>
 
 #include <components/esm/loadalch.hpp>
@@ -20,47 +22,66 @@
 
 namespace
 {
-    bool compareType(const std::string& type1, const std::string& type2)
+    int getTypeOrder(const std::string& type)
     {
-        // this defines the sorting order of types. types that are first in the vector appear before other types.
-        std::vector<std::string> mapping;
-        mapping.push_back( typeid(ESM::Weapon).name() );
-        mapping.push_back( typeid(ESM::Armor).name() );
-        mapping.push_back( typeid(ESM::Clothing).name() );
-        mapping.push_back( typeid(ESM::Potion).name() );
-        mapping.push_back( typeid(ESM::Ingredient).name() );
-        mapping.push_back( typeid(ESM::Apparatus).name() );
-        mapping.push_back( typeid(ESM::Book).name() );
-        mapping.push_back( typeid(ESM::Light).name() );
-        mapping.push_back( typeid(ESM::Miscellaneous).name() );
-        mapping.push_back( typeid(ESM::Lockpick).name() );
-        mapping.push_back( typeid(ESM::Repair).name() );
-        mapping.push_back( typeid(ESM::Probe).name() );
-
-        assert( std::find(mapping.begin(), mapping.end(), type1) != mapping.end() );
-        assert( std::find(mapping.begin(), mapping.end(), type2) != mapping.end() );
-
-        return std::find(mapping.begin(), mapping.end(), type1) < std::find(mapping.begin(), mapping.end(), type2);
+        // this defines the sorting order of types. types that are first in the list appear before other types.
+        static std::map<std::string, int> order;
+        if (order.empty())
+        {
+            const char *types[] =
+            {
+                typeid(ESM::Weapon).name(),
+                typeid(ESM::Armor).name(),
+                typeid(ESM::Clothing).name(),
+                typeid(ESM::Potion).name(),
+                typeid(ESM::Ingredient).name(),
+                typeid(ESM::Apparatus).name(),
+                typeid(ESM::Book).name(),
+                typeid(ESM::Light).name(),
+                typeid(ESM::Miscellaneous).name(),
+                typeid(ESM::Lockpick).name(),
+                typeid(ESM::Repair).name(),
+                typeid(ESM::Probe).name()
+            };
+
+            for (size_t i=0; i<sizeof(types)/sizeof(types[0]); ++i)
+                order[types[i]] = static_cast<int>(i);
+        }
+
+        std::map<std::string, int>::const_iterator found = order.find(type);
+        assert(found != order.end());
+        return found != order.end() ? found->second : static_cast<int>(order.size());
     }
 
+    /// Everything the sorting looks at, computed once per stack instead of once per comparison
+    struct SortKey
+    {
+        MWGui::ItemStack::Type mType;
+        int mTypeOrder;
+        std::string mName; // lower case
+        size_t mIndex;
+
+        SortKey(const MWGui::ItemStack& item, size_t index)
+            : mType(item.mType)
+            , mTypeOrder(getTypeOrder(item.mBase.getTypeName()))
+            , mName(Misc::StringUtils::lowerCase(item.mBase.getClass().getName(item.mBase)))
+            , mIndex(index)
+        {}
+    };
+
     struct Compare
     {
         bool mSortByType;
         Compare() : mSortByType(true) {}
-        bool operator() (const MWGui::ItemStack& left, const MWGui::ItemStack& right)
+        bool operator() (const SortKey& left, const SortKey& right) const
         {
             if (mSortByType && left.mType != right.mType)
                 return left.mType < right.mType;
 
-            if (left.mBase.getTypeName() == right.mBase.getTypeName())
-            {
-                std::string leftName = Misc::StringUtils::lowerCase(left.mBase.getClass().getName(left.mBase));
-                std::string rightName = Misc::StringUtils::lowerCase(right.mBase.getClass().getName(right.mBase));
+            if (left.mTypeOrder != right.mTypeOrder)
+                return left.mTypeOrder < right.mTypeOrder;
 
-                return leftName.compare(rightName) < 0;
-            }
-            else
-                return compareType(left.mBase.getTypeName(), right.mBase.getTypeName());
+            return left.mName.compare(right.mName) < 0;
         }
     };
 }
@@ -173,7 +194,8 @@ namespace MWGui
 
         size_t count = mSourceModel->getItemCount();
 
-        mItems.clear();
+        std::vector<ItemStack> items;
+        items.reserve(count);
         for (size_t i=0; i<count; ++i)
         {
             ItemStack item = mSourceModel->getItem(i);
@@ -189,12 +211,22 @@ namespace MWGui
             }
 
             if (item.mCount > 0 && filterAccepts(item))
-                mItems.push_back(item);
+                items.push_back(item);
         }
 
+        std::vector<SortKey> keys;
+        keys.reserve(items.size());
+        for (size_t i=0; i<items.size(); ++i)
+            keys.push_back(SortKey(items[i], i));
+
         Compare cmp;
         cmp.mSortByType = mSortByType;
-        std::sort(mItems.begin(), mItems.end(), cmp);
+        std::sort(keys.begin(), keys.end(), cmp);
+
+        mItems.clear();
+        mItems.reserve(keys.size());
+        for (std::vector<SortKey>::const_iterator it = keys.begin(); it != keys.end(); ++it)
+            mItems.push_back(items[it->mIndex]);
     }
 
 }
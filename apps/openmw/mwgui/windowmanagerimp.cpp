@@ -175,6 +175,7 @@ namespace MWGui
       , mTriangleCount(0)
       , mBatchCount(0)
       , mFallbackMap(fallbackMap)
+      , mCacheDir(cacheDir)
     {
         // Set up the GUI system
         mGuiManager = new OEngine::GUI::MyGUIManager(mRendering->getWindow(), mRendering->getScene(), false, logpath);
@@ -253,7 +254,7 @@ namespace MWGui
 
         mRecharge = new Recharge();
         mMenu = new MainMenu(w,h);
-        mMap = new MapWindow(mCustomMarkers, mDragAndDrop, "");
+        mMap = new MapWindow(mCustomMarkers, mDragAndDrop, mCacheDir);
         trackWindow(mMap, "map");
         mStatsWindow = new StatsWindow(mDragAndDrop);
         trackWindow(mStatsWindow, "stats");
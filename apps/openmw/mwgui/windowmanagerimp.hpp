@@ -462,6 +462,8 @@ namespace MWGui
 
     std::map<std::string, std::string> mFallbackMap;
 
+    std::string mCacheDir;
+
     /**
      * Called when MyGUI tries to retrieve a tag's value. Tags must be denoted in #{tag} notation and will be replaced upon setting a user visible text/property.
      * Supported syntax:
@@ -15,20 +15,21 @@ namespace MWMechanics
 {
     void ActiveSpells::update() const
     {
-        bool rebuild = false;
-
         MWWorld::TimeStamp now = MWBase::Environment::get().getWorld()->getTimeStamp();
 
-        // Erase no longer active spells and effects
-        if (mLastUpdate!=now)
+        // Erase no longer active spells and effects. Incremental updates only work, if the
+        // expired effects are removed before the effects are rebuilt.
+        if (mLastUpdate!=now || mSpellsChanged)
         {
             TContainer::iterator iter (mSpells.begin());
             while (iter!=mSpells.end())
             {
                 if (!timeToExpire (iter))
                 {
+                    if (!mSpellsChanged)
+                        removeFromMagicEffects (iter->second.mEffects);
+
                     mSpells.erase (iter++);
-                    rebuild = true;
                 }
                 else
                 {
@@ -39,8 +40,10 @@ namespace MWMechanics
                         MWWorld::TimeStamp end = start + static_cast<double>(effectIt->mDuration)*MWBase::Environment::get().getWorld()->getTimeScaleFactor()/(60*60);
                         if (end <= now)
                         {
+                            if (!mSpellsChanged)
+                                removeFromMagicEffects (*effectIt);
+
                             effectIt = effects.erase(effectIt);
-                            rebuild = true;
                         }
                         else
                             ++effectIt;
@@ -55,36 +58,63 @@ namespace MWMechanics
         if (mSpellsChanged)
         {
             mSpellsChanged = false;
-            rebuild = true;
-        }
-
-        if (rebuild)
             rebuildEffects();
+        }
     }
 
     void ActiveSpells::rebuildEffects() const
     {
-        MWWorld::TimeStamp now = MWBase::Environment::get().getWorld()->getTimeStamp();
-
         mEffects = MagicEffects();
+        mEffectCounts.clear();
 
         for (TIterator iter (begin()); iter!=end(); ++iter)
-        {
-            const MWWorld::TimeStamp& start = iter->second.mTimeStamp;
+            addToMagicEffects (iter->second.mEffects);
+    }
 
-            const std::vector<ActiveEffect>& effects = iter->second.mEffects;
+    void ActiveSpells::addToMagicEffects (const ActiveEffect& effect) const
+    {
+        // Effects without a duration expire immediately and never contribute.
+        if (effect.mDuration<=0)
+            return;
 
-            for (std::vector<ActiveEffect>::const_iterator effectIt = effects.begin(); effectIt != effects.end(); ++effectIt)
-            {
-                double duration = effectIt->mDuration;
-                MWWorld::TimeStamp end = start;
-                end += duration * 
-                    MWBase::Environment::get().getWorld()->getTimeScaleFactor()/(60*60);
+        EffectKey key (effect.mEffectId, effect.mArg);
 
-                if (end>now)
-                    mEffects.add(MWMechanics::EffectKey(effectIt->mEffectId, effectIt->mArg), MWMechanics::EffectParam(effectIt->mMagnitude));
-            }
+        mEffects.add (key, EffectParam (effect.mMagnitude));
+        ++mEffectCounts[key];
+    }
+
+    void ActiveSpells::removeFromMagicEffects (const ActiveEffect& effect) const
+    {
+        if (effect.mDuration<=0)
+            return;
+
+        EffectKey key (effect.mEffectId, effect.mArg);
+
+        std::map<EffectKey, int>::iterator iter = mEffectCounts.find (key);
+
+        if (iter==mEffectCounts.end())
+            return;
+
+        if (--iter->second<=0)
+        {
+            // drop the key entirely, so no rounding errors from the subtractions remain
+            mEffectCounts.erase (iter);
+            mEffects.remove (key);
         }
+        else
+            mEffects.add (key, EffectParam() - EffectParam (effect.mMagnitude));
+    }
+
+    void ActiveSpells::addToMagicEffects (const std::vector<ActiveEffect>& effects) const
+    {
+        for (std::vector<ActiveEffect>::const_iterator iter (effects.begin()); iter!=effects.end(); ++iter)
+            addToMagicEffects (*iter);
+    }
+
+    void ActiveSpells::removeFromMagicEffects (const std::vector<ActiveEffect>& effects) const
+    {
+        for (std::vector<ActiveEffect>::const_iterator iter (effects.begin()); iter!=effects.end(); ++iter)
+            removeFromMagicEffects (*iter);
     }
 
     ActiveSpells::ActiveSpells()
@@ -173,10 +203,15 @@ namespace MWMechanics
             // so, if we see new effects for same spell assume additional 
             // spell effects and add to existing effects of spell
             mergeEffects(params.mEffects, it->second.mEffects);
+
+            if (!mSpellsChanged)
+                removeFromMagicEffects (it->second.mEffects);
+
             it->second = params;
         }
 
-        mSpellsChanged = true;
+        if (!mSpellsChanged)
+            addToMagicEffects (params.mEffects);
     }
 
     void ActiveSpells::mergeEffects(std::vector<ActiveEffect>& addTo, const std::vector<ActiveEffect>& from)
@@ -202,8 +237,14 @@ namespace MWMechanics
 
     void ActiveSpells::removeEffects(const std::string &id)
     {
-        mSpells.erase(Misc::StringUtils::lowerCase(id));
-        mSpellsChanged = true;
+        std::pair<TContainer::iterator, TContainer::iterator> range =
+            mSpells.equal_range (Misc::StringUtils::lowerCase(id));
+
+        if (!mSpellsChanged)
+            for (TContainer::iterator iter (range.first); iter!=range.second; ++iter)
+                removeFromMagicEffects (iter->second.mEffects);
+
+        mSpells.erase (range.first, range.second);
     }
 
     void ActiveSpells::visitEffectSources(EffectSourceVisitor &visitor) const
@@ -48,6 +48,7 @@ namespace MWMechanics
 
             mutable TContainer mSpells;
             mutable MagicEffects mEffects;
+            mutable std::map<EffectKey, int> mEffectCounts; // number of active effects per key
             mutable bool mSpellsChanged;
             mutable MWWorld::TimeStamp mLastUpdate;
 
@@ -55,6 +56,16 @@ namespace MWMechanics
             
             void rebuildEffects() const;
 
+            void addToMagicEffects (const ActiveEffect& effect) const;
+            ///< Add the contribution of \a effect to mEffects.
+
+            void removeFromMagicEffects (const ActiveEffect& effect) const;
+            ///< Remove the contribution of \a effect from mEffects.
+
+            void addToMagicEffects (const std::vector<ActiveEffect>& effects) const;
+
+            void removeFromMagicEffects (const std::vector<ActiveEffect>& effects) const;
+
             /// Add any effects that are in "from" and not in "addTo" to "addTo"
             void mergeEffects(std::vector<ActiveEffect>& addTo, const std::vector<ActiveEffect>& from);
 
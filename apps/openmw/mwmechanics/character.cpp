@@ -1096,8 +1096,9 @@ bool CharacterController::updateWeaponState()
                     mAttackType = "shoot";
                 else
                 {
+                    static const Settings::BoolValue bestAttack("best attack", "Game");
                     if(isWeapon && mPtr == MWBase::Environment::get().getWorld()->getPlayerPtr() &&
-                            Settings::Manager::getBool("best attack", "Game"))
+                            bestAttack.get())
                     {
                         MWWorld::ContainerStoreIterator weapon = mPtr.getClass().getInventoryStore(mPtr).getSlot(MWWorld::InventoryStore::Slot_CarriedRight);
                         mAttackType = getBestAttack(weapon->get<ESM::Weapon>()->mBase);
@@ -11,7 +11,8 @@ float scaleDamage(float damage, const MWWorld::Ptr& attacker, const MWWorld::Ptr
     const MWWorld::Ptr& player = MWBase::Environment::get().getWorld()->getPlayerPtr();
 
     // [-100, 100]
-    int difficultySetting = Settings::Manager::getInt("difficulty", "Game");
+    static const Settings::IntValue difficulty("difficulty", "Game");
+    int difficultySetting = difficulty.get();
 
     static const float fDifficultyMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fDifficultyMult")->getFloat();
 
@@ -3,6 +3,8 @@
 
 #include <cstdlib>
 
+#include <algorithm>
+
 #include <stdexcept>
 
 #include <components/esm/effectlist.hpp>
@@ -30,6 +32,17 @@ namespace MWMechanics
         }
     }
 
+    namespace
+    {
+        struct EntryLess
+        {
+            bool operator() (const MagicEffects::Entry& left, const MagicEffects::Entry& right) const
+            {
+                return left.first<right.first;
+            }
+        };
+    }
+
     bool operator< (const EffectKey& left, const EffectKey& right)
     {
         if (left.mId<right.mId)
@@ -87,40 +100,129 @@ namespace MWMechanics
         return *this;
     }
 
-    void MagicEffects::remove(const EffectKey &key)
+    MagicEffects::const_iterator::const_iterator (const MagicEffects *effects, std::size_t index)
+    : mEffects (effects), mIndex (index)
     {
-        mCollection.erase(key);
+        seek();
     }
 
-    void MagicEffects::add (const EffectKey& key, const EffectParam& param)
+    void MagicEffects::const_iterator::seek()
+    {
+        std::size_t size = ESM::MagicEffect::Length;
+
+        for (; mIndex<size; ++mIndex)
+            if (mEffects->mPresent[mIndex])
+            {
+                mValue.first = EffectKey (static_cast<int> (mIndex));
+                mValue.second = mEffects->mEffects[mIndex];
+                return;
+            }
+
+        if (mIndex-size<mEffects->mArgEffects.size())
+            mValue = mEffects->mArgEffects[mIndex-size];
+    }
+
+    MagicEffects::const_iterator& MagicEffects::const_iterator::operator++()
+    {
+        ++mIndex;
+        seek();
+        return *this;
+    }
+
+    MagicEffects::const_iterator MagicEffects::const_iterator::operator++ (int)
     {
-        Collection::iterator iter = mCollection.find (key);
+        const_iterator iter (*this);
+        ++*this;
+        return iter;
+    }
 
-        if (iter==mCollection.end())
+    MagicEffects::MagicEffects()
+    {
+        std::fill (mPresent, mPresent+ESM::MagicEffect::Length, false);
+    }
+
+    bool MagicEffects::isIndexed (const EffectKey& key)
+    {
+        return key.mArg==-1 && key.mId>=0 && key.mId<ESM::MagicEffect::Length;
+    }
+
+    const EffectParam *MagicEffects::find (const EffectKey& key) const
+    {
+        if (isIndexed (key))
+            return mPresent[key.mId] ? &mEffects[key.mId] : 0;
+
+        std::vector<Entry>::const_iterator iter = std::lower_bound (mArgEffects.begin(),
+            mArgEffects.end(), Entry (key, EffectParam()), EntryLess());
+
+        if (iter!=mArgEffects.end() && !(key<iter->first))
+            return &iter->second;
+
+        return 0;
+    }
+
+    EffectParam& MagicEffects::insert (const EffectKey& key)
+    {
+        if (isIndexed (key))
         {
-            mCollection.insert (std::make_pair (key, param));
+            if (!mPresent[key.mId])
+            {
+                mPresent[key.mId] = true;
+                mEffects[key.mId] = EffectParam();
+            }
+
+            return mEffects[key.mId];
         }
-        else
+
+        Entry entry (key, EffectParam());
+
+        std::vector<Entry>::iterator iter = std::lower_bound (mArgEffects.begin(),
+            mArgEffects.end(), entry, EntryLess());
+
+        if (iter==mArgEffects.end() || key<iter->first)
+            iter = mArgEffects.insert (iter, entry);
+
+        return iter->second;
+    }
+
+    void MagicEffects::remove(const EffectKey &key)
+    {
+        if (isIndexed (key))
         {
-            iter->second += param;
+            mPresent[key.mId] = false;
+            return;
         }
+
+        std::vector<Entry>::iterator iter = std::lower_bound (mArgEffects.begin(),
+            mArgEffects.end(), Entry (key, EffectParam()), EntryLess());
+
+        if (iter!=mArgEffects.end() && !(key<iter->first))
+            mArgEffects.erase (iter);
+    }
+
+    void MagicEffects::add (const EffectKey& key, const EffectParam& param)
+    {
+        insert (key) += param;
     }
 
     void MagicEffects::modifyBase(const EffectKey &key, int diff)
     {
-        mCollection[key].modifyBase(diff);
+        insert (key).modifyBase(diff);
     }
 
     void MagicEffects::setModifiers(const MagicEffects &effects)
     {
-        for (Collection::iterator it = mCollection.begin(); it != mCollection.end(); ++it)
+        for (int i=0; i<ESM::MagicEffect::Length; ++i)
+            if (mPresent[i])
+                mEffects[i].setModifier (effects.get (EffectKey (i)).getModifier());
+
+        for (std::vector<Entry>::iterator it = mArgEffects.begin(); it != mArgEffects.end(); ++it)
         {
             it->second.setModifier(effects.get(it->first).getModifier());
         }
 
-        for (Collection::const_iterator it = effects.begin(); it != effects.end(); ++it)
+        for (const_iterator it = effects.begin(); it != effects.end(); ++it)
         {
-            mCollection[it->first].setModifier(it->second.getModifier());
+            insert (it->first).setModifier(it->second.getModifier());
         }
     }
 
@@ -133,31 +235,18 @@ namespace MWMechanics
             return *this;
         }
 
-        for (Collection::const_iterator iter (effects.begin()); iter!=effects.end(); ++iter)
-        {
-            Collection::iterator result = mCollection.find (iter->first);
-
-            if (result!=mCollection.end())
-                result->second += iter->second;
-            else
-                mCollection.insert (*iter);
-        }
+        for (const_iterator iter (effects.begin()); iter!=effects.end(); ++iter)
+            add (iter->first, iter->second);
 
         return *this;
     }
 
     EffectParam MagicEffects::get (const EffectKey& key) const
     {
-        Collection::const_iterator iter = mCollection.find (key);
+        if (const EffectParam *param = find (key))
+            return *param;
 
-        if (iter==mCollection.end())
-        {
-            return EffectParam();
-        }
-        else
-        {
-            return iter->second;
-        }
+        return EffectParam();
     }
 
     MagicEffects MagicEffects::diff (const MagicEffects& prev, const MagicEffects& now)
@@ -165,27 +254,24 @@ namespace MWMechanics
         MagicEffects result;
 
         // adding/changing
-        for (Collection::const_iterator iter (now.begin()); iter!=now.end(); ++iter)
+        for (const_iterator iter (now.begin()); iter!=now.end(); ++iter)
         {
-            Collection::const_iterator other = prev.mCollection.find (iter->first);
-
-            if (other==prev.end())
+            if (const EffectParam *other = prev.find (iter->first))
             {
-                // adding
-                result.add (iter->first, iter->second);
+                // changing
+                result.add (iter->first, iter->second - *other);
             }
             else
             {
-                // changing
-                result.add (iter->first, iter->second - other->second);
+                // adding
+                result.add (iter->first, iter->second);
             }
         }
 
         // removing
-        for (Collection::const_iterator iter (prev.begin()); iter!=prev.end(); ++iter)
+        for (const_iterator iter (prev.begin()); iter!=prev.end(); ++iter)
         {
-            Collection::const_iterator other = now.mCollection.find (iter->first);
-            if (other==now.end())
+            if (!now.find (iter->first))
             {
                 result.add (iter->first, EffectParam() - iter->second);
             }
@@ -197,7 +283,7 @@ namespace MWMechanics
     void MagicEffects::writeState(ESM::MagicEffects &state) const
     {
         // Don't need to save Modifiers, they are recalculated every frame anyway.
-        for (Collection::const_iterator iter (begin()); iter!=end(); ++iter)
+        for (const_iterator iter (begin()); iter!=end(); ++iter)
         {
             if (iter->second.getBase() != 0)
             {
@@ -211,7 +297,7 @@ namespace MWMechanics
     {
         for (std::map<int, int>::const_iterator it = state.mEffects.begin(); it != state.mEffects.end(); ++it)
         {
-            mCollection[EffectKey(it->first)].setBase(it->second);
+            insert (EffectKey(it->first)).setBase(it->second);
         }
     }
 }
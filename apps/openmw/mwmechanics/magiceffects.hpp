@@ -3,6 +3,9 @@
 
 #include <map>
 #include <string>
+#include <vector>
+
+#include <components/esm/loadmgef.hpp>
 
 namespace ESM
 {
@@ -80,27 +83,73 @@ namespace MWMechanics
     };
 
     /// \brief Effects currently affecting a NPC or creature
+    ///
+    /// Effects without an argument are stored in a fixed-size array indexed by effect ID. The few
+    /// effects that take an argument (skill or attribute) are kept in a small sorted side table.
     class MagicEffects
     {
         public:
 
-            typedef std::map<EffectKey, EffectParam> Collection;
+            typedef std::pair<EffectKey, EffectParam> Entry;
+
+            /// \brief Iterates over all present effects (argument-less effects first)
+            class const_iterator
+            {
+                    const MagicEffects *mEffects;
+                    std::size_t mIndex;
+                    Entry mValue;
+
+                    void seek();
+                    ///< Skip to the next present effect, starting at mIndex.
+
+                public:
+
+                    const_iterator (const MagicEffects *effects, std::size_t index);
+
+                    const Entry& operator* () const { return mValue; }
+
+                    const Entry *operator-> () const { return &mValue; }
+
+                    const_iterator& operator++();
+
+                    const_iterator operator++ (int);
+
+                    bool operator== (const const_iterator& iter) const { return mIndex==iter.mIndex; }
+
+                    bool operator!= (const const_iterator& iter) const { return mIndex!=iter.mIndex; }
+            };
 
         private:
 
-            Collection mCollection;
+            EffectParam mEffects[ESM::MagicEffect::Length];
+            bool mPresent[ESM::MagicEffect::Length];
+            std::vector<Entry> mArgEffects; // sorted by key
+
+            static bool isIndexed (const EffectKey& key);
+
+            const EffectParam *find (const EffectKey& key) const;
+            ///< Return 0, if \a key is not present.
+
+            EffectParam& insert (const EffectKey& key);
+            ///< Return the existing entry for \a key or create a new one.
 
         public:
 
-            Collection::const_iterator begin() const { return mCollection.begin(); }
+            MagicEffects();
+
+            const_iterator begin() const { return const_iterator (this, 0); }
 
-            Collection::const_iterator end() const { return mCollection.end(); }
+            const_iterator end() const
+            {
+                return const_iterator (this, ESM::MagicEffect::Length + mArgEffects.size());
+            }
 
             void readState (const ESM::MagicEffects& state);
             void writeState (ESM::MagicEffects& state) const;
 
             void add (const EffectKey& key, const EffectParam& param);
             void remove (const EffectKey& key);
+            ///< \note Invalidates iterators.
 
             void modifyBase (const EffectKey& key, int diff);
 
@@ -5,6 +5,7 @@
 #include <openengine/misc/rng.hpp>
 
 #include <components/esm/stolenitems.hpp>
+#include <components/misc/profiler.hpp>
 
 #include "../mwworld/esmstore.hpp"
 #include "../mwworld/inventorystore.hpp"
@@ -367,6 +368,8 @@ namespace MWMechanics
 
     void MechanicsManager::update(float duration, bool paused)
     {
+        Misc::ProfileZone zone ("MechanicsManager::update");
+
         if(!mWatched.isEmpty())
         {
             MWBase::WindowManager *winMgr = MWBase::Environment::get().getWindowManager();
@@ -494,8 +497,14 @@ namespace MWMechanics
             mActors.addActor(ptr, true);
         }
 
-        mActors.update(duration, paused);
-        mObjects.update(duration, paused);
+        {
+            Misc::ProfileZone actorsZone ("Actors");
+            mActors.update(duration, paused);
+        }
+        {
+            Misc::ProfileZone objectsZone ("Objects");
+            mObjects.update(duration, paused);
+        }
     }
 
     void MechanicsManager::rest(bool sleep)
@@ -74,14 +74,15 @@ namespace MWMechanics
             if (mPermanentSpellEffects.find(lower) != mPermanentSpellEffects.end())
             {
                 MagicEffects & effects = mPermanentSpellEffects[lower];
-                for (MagicEffects::Collection::const_iterator effectIt = effects.begin(); effectIt != effects.end();)
+                std::vector<EffectKey> harmful;
+                for (MagicEffects::const_iterator effectIt = effects.begin(); effectIt != effects.end(); ++effectIt)
                 {
                     const ESM::MagicEffect * magicEffect = MWBase::Environment::get().getWorld()->getStore().get<ESM::MagicEffect>().find(effectIt->first.mId);
                     if (magicEffect->mData.mFlags & ESM::MagicEffect::Harmful)
-                        effects.remove((effectIt++)->first);
-                    else
-                        ++effectIt;
+                        harmful.push_back(effectIt->first);
                 }
+                for (std::vector<EffectKey>::const_iterator keyIt = harmful.begin(); keyIt != harmful.end(); ++keyIt)
+                    effects.remove(*keyIt);
             }
             mCorprusSpells.erase(corprusIt);
         }
@@ -379,7 +380,7 @@ namespace MWMechanics
         for (std::map<std::string, MagicEffects>::const_iterator it = mPermanentSpellEffects.begin(); it != mPermanentSpellEffects.end(); ++it)
         {
             std::vector<ESM::SpellState::PermanentSpellEffectInfo> effectList;
-            for (MagicEffects::Collection::const_iterator effectIt = it->second.begin(); effectIt != it->second.end(); ++effectIt)
+            for (MagicEffects::const_iterator effectIt = it->second.begin(); effectIt != it->second.end(); ++effectIt)
             {
                 ESM::SpellState::PermanentSpellEffectInfo info;
                 info.mId = effectIt->first.mId;
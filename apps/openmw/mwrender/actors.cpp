@@ -194,8 +194,6 @@ void Actors::updateObjectCell(const MWWorld::Ptr &old, const MWWorld::Ptr &cur)
         anim->updatePtr(cur);
         mAllActors[cur] = anim;
     }
-
-    mRendering->updateWaterRippleEmitterPtr (old, cur);
 }
 
 void Actors::enableLights()
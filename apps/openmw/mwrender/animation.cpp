@@ -1,5 +1,8 @@
 #include "animation.hpp"
 
+#include <map>
+#include <vector>
+
 #include <OgreSkeletonManager.h>
 #include <OgreSkeletonInstance.h>
 #include <OgreEntity.h>
@@ -214,6 +217,10 @@ void Animation::setRenderProperties(NifOgre::ObjectScenePtr objlist, Ogre::uint3
     if (enchantedGlow)
         std::for_each(objlist->mEntities.begin(), objlist->mEntities.end(),
                   AddGlow(glowColor, &objlist->mMaterialControllerMgr));
+
+    OEngine::Render::LightManager& lightManager = OEngine::Render::LightManager::getInstance();
+    for (std::vector<Ogre::Entity*>::iterator it = objlist->mEntities.begin(); it != objlist->mEntities.end(); ++it)
+        lightManager.addObject(*it);
 }
 
 
@@ -337,18 +344,14 @@ void Animation::addExtraLight(Ogre::SceneManager *sceneMgr, NifOgre::ObjectScene
 
     objlist->mLights.push_back(sceneMgr->createLight());
     Ogre::Light *olight = objlist->mLights.back();
-    olight->setDiffuseColour(color);
 
-    Ogre::ControllerValueRealPtr src(Ogre::ControllerManager::getSingleton().getFrameTimeSource());
-    Ogre::ControllerValueRealPtr dest(OGRE_NEW OEngine::Render::LightValue(olight, color));
-    Ogre::ControllerFunctionRealPtr func(OGRE_NEW OEngine::Render::LightFunction(
+    OEngine::Render::LightManager::getInstance().addLight(olight,
         (light->mData.mFlags&ESM::Light::Flicker) ? OEngine::Render::LT_Flicker :
         (light->mData.mFlags&ESM::Light::FlickerSlow) ? OEngine::Render::LT_FlickerSlow :
         (light->mData.mFlags&ESM::Light::Pulse) ? OEngine::Render::LT_Pulse :
         (light->mData.mFlags&ESM::Light::PulseSlow) ? OEngine::Render::LT_PulseSlow :
-        OEngine::Render::LT_Normal
-    ));
-    objlist->mControllers.push_back(Ogre::Controller<Ogre::Real>(src, dest, func));
+        OEngine::Render::LT_Normal,
+        color);
 
     bool interior = !(mPtr.isInCell() && mPtr.getCell()->getCell()->isExterior());
 
@@ -568,13 +571,70 @@ float Animation::getVelocity(const std::string &groupname) const
 }
 
 
-static void updateBoneTree(const Ogre::SkeletonInstance *skelsrc, Ogre::Bone *bone)
+namespace
 {
-    if(bone->getName() != " " // really should be != "", but see workaround in skeleton.cpp for empty node names
-            && skelsrc->hasBone(bone->getName()))
+    struct BoneBinding
+    {
+        unsigned short mSource;
+        unsigned short mTarget;
+        bool mCopyLocal; // copy the local transformation instead of the derived one
+    };
+    typedef std::vector<BoneBinding> BoneBindingList;
+
+    void bindBoneTree(const Ogre::SkeletonInstance *skelsrc, Ogre::Bone *bone, BoneBindingList &bindings)
     {
-        Ogre::Bone *srcbone = skelsrc->getBone(bone->getName());
-        if(!srcbone->getParent() || !bone->getParent())
+        if(bone->getName() != " " // really should be != "", but see workaround in skeleton.cpp for empty node names
+                && skelsrc->hasBone(bone->getName()))
+        {
+            Ogre::Bone *srcbone = skelsrc->getBone(bone->getName());
+
+            BoneBinding binding;
+            binding.mSource = srcbone->getHandle();
+            binding.mTarget = bone->getHandle();
+            binding.mCopyLocal = (!srcbone->getParent() || !bone->getParent());
+            bindings.push_back(binding);
+        }
+
+        // Parents are bound before their children, so derived transformations are applied top-down
+        Ogre::Node::ChildNodeIterator boneiter = bone->getChildIterator();
+        while(boneiter.hasMoreElements())
+            bindBoneTree(skelsrc, static_cast<Ogre::Bone*>(boneiter.getNext()), bindings);
+    }
+
+    /// Bones of \a skel matching bones of \a skelsrc by name. Skeletons are named after the
+    /// model they were loaded from, and all instances of a skeleton share its bone handles, so
+    /// the matching is done once per pair of models and shared by every actor using them.
+    const BoneBindingList &getBoneBindings(const Ogre::SkeletonInstance *skelsrc, Ogre::SkeletonInstance *skel)
+    {
+        typedef std::map<std::pair<std::string, std::string>, BoneBindingList> BoneBindingMap;
+        static BoneBindingMap sBindings;
+
+        std::pair<std::string, std::string> key(skelsrc->getName(), skel->getName());
+
+        BoneBindingMap::const_iterator found = sBindings.find(key);
+        if(found != sBindings.end())
+            return found->second;
+
+        BoneBindingList &bindings = sBindings[key];
+
+        Ogre::Skeleton::BoneIterator boneiter = skel->getRootBoneIterator();
+        while(boneiter.hasMoreElements())
+            bindBoneTree(skelsrc, boneiter.getNext(), bindings);
+
+        return bindings;
+    }
+}
+
+void Animation::updateSkeletonInstance(const Ogre::SkeletonInstance *skelsrc, Ogre::SkeletonInstance *skel)
+{
+    const BoneBindingList &bindings = getBoneBindings(skelsrc, skel);
+
+    for(BoneBindingList::const_iterator iter = bindings.begin();iter != bindings.end();++iter)
+    {
+        Ogre::Bone *srcbone = skelsrc->getBone(iter->mSource);
+        Ogre::Bone *bone = skel->getBone(iter->mTarget);
+
+        if(iter->mCopyLocal)
         {
             bone->setOrientation(srcbone->getOrientation());
             bone->setPosition(srcbone->getPosition());
@@ -587,17 +647,6 @@ static void updateBoneTree(const Ogre::SkeletonInstance *skelsrc, Ogre::Bone *bo
             bone->setScale(Ogre::Vector3::UNIT_SCALE);
         }
     }
-
-    Ogre::Node::ChildNodeIterator boneiter = bone->getChildIterator();
-    while(boneiter.hasMoreElements())
-        updateBoneTree(skelsrc, static_cast<Ogre::Bone*>(boneiter.getNext()));
-}
-
-void Animation::updateSkeletonInstance(const Ogre::SkeletonInstance *skelsrc, Ogre::SkeletonInstance *skel)
-{
-    Ogre::Skeleton::BoneIterator boneiter = skel->getRootBoneIterator();
-    while(boneiter.hasMoreElements())
-        updateBoneTree(skelsrc, boneiter.getNext());
 }
 
 
@@ -1492,13 +1541,16 @@ ObjectAnimation::ObjectAnimation(const MWWorld::Ptr& ptr, const std::string &mod
         Ogre::Vector3 extents = getWorldBounds().getSize();
         float size = std::max(std::max(extents.x, extents.y), extents.z);
 
-        bool small = (size < Settings::Manager::getInt("small object size", "Viewing distance")) &&
-                     Settings::Manager::getBool("limit small object distance", "Viewing distance");
+        static const Settings::IntValue smallObjectSize("small object size", "Viewing distance");
+        static const Settings::BoolValue limitSmallObjectDistance("limit small object distance", "Viewing distance");
+        static const Settings::IntValue smallObjectDistance("small object distance", "Viewing distance");
+
+        bool small = (size < smallObjectSize.get()) && limitSmallObjectDistance.get();
         // do not fade out doors. that will cause holes and look stupid
         if(ptr.getTypeName().find("Door") != std::string::npos)
             small = false;
 
-        float dist = small ? Settings::Manager::getInt("small object distance", "Viewing distance") : 0.0f;
+        float dist = small ? smallObjectDistance.get() : 0.0f;
         Ogre::Vector3 col = getEnchantmentColor(ptr);
         setRenderProperties(mObjectRoot, (mPtr.getTypeName() == typeid(ESM::Static).name()) ?
                                          (small ? RV_StaticsSmall : RV_Statics) : RV_Misc,
@@ -157,7 +157,8 @@ protected:
                                   const std::string &groupname);
 
     /* Updates a skeleton instance so that all bones matching the source skeleton (based on
-     * bone names) are positioned identically. */
+     * bone names) are positioned identically. The bones are matched by name only the first
+     * time a pair of skeletons is seen. */
     void updateSkeletonInstance(const Ogre::SkeletonInstance *skelsrc, Ogre::SkeletonInstance *skel);
 
     /* Updates the position of the accum root node for the given time, and
@@ -1,7 +1,15 @@
 #include "globalmap.hpp"
 
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+
 #include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 #include <OgreImage.h>
 #include <OgreTextureManager.h>
@@ -14,12 +22,21 @@
 #include <components/settings/settings.hpp>
 
 #include <components/esm/globalmap.hpp>
+#include <components/esm/esmreader.hpp>
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
 
 #include "../mwworld/esmstore.hpp"
 
+namespace
+{
+    const char *cacheFileName = "globalmap.cache";
+
+    // Increase when the generated image changes, to invalidate existing caches
+    const int cacheVersion = 1;
+}
+
 namespace MWRender
 {
 
@@ -64,23 +81,93 @@ namespace MWRender
 
         loadingListener->loadingOn();
         loadingListener->setLabel("Creating map");
-        loadingListener->setProgressRange((mMaxX-mMinX+1) * (mMaxY-mMinY+1));
-        loadingListener->setProgress(0);
 
         std::vector<Ogre::uchar> data (mWidth * mHeight * 3);
 
-        for (int x = mMinX; x <= mMaxX; ++x)
+        std::size_t cacheKey = getCacheKey();
+
+        if (!readCache (cacheKey, data))
+        {
+            // Columns are interleaved between the threads, so every thread gets a similar share of
+            // land and water. Each land is only ever touched by one thread.
+            int threads = std::max (1, std::min (static_cast<int> (boost::thread::hardware_concurrency()),
+                mMaxX-mMinX+1));
+
+            loadingListener->setProgressRange (threads);
+            loadingListener->setProgress (0);
+
+            std::vector<boost::thread*> workers;
+            std::vector<std::string> errors (threads);
+
+            for (int i=1; i<threads; ++i)
+                workers.push_back (new boost::thread (boost::bind (&GlobalMap::renderCellsNoThrow, this,
+                    boost::ref (data), i, threads, boost::ref (errors[i]))));
+
+            renderCellsNoThrow (data, 0, threads, errors[0]);
+            loadingListener->increaseProgress();
+
+            for (std::vector<boost::thread*>::iterator iter (workers.begin()); iter!=workers.end(); ++iter)
+            {
+                (*iter)->join();
+                delete *iter;
+                loadingListener->increaseProgress();
+            }
+
+            for (std::vector<std::string>::const_iterator iter (errors.begin()); iter!=errors.end(); ++iter)
+                if (!iter->empty())
+                    throw std::runtime_error (*iter);
+
+            writeCache (cacheKey, data);
+        }
+
+        Ogre::DataStreamPtr stream(new Ogre::MemoryDataStream(&data[0], data.size()));
+
+        tex = Ogre::TextureManager::getSingleton ().createManual ("GlobalMap.png", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+            Ogre::TEX_TYPE_2D, mWidth, mHeight, 0, Ogre::PF_B8G8R8, Ogre::TU_STATIC);
+        tex->loadRawData(stream, mWidth, mHeight, Ogre::PF_B8G8R8);
+
+        tex->load();
+
+        mOverlayTexture = Ogre::TextureManager::getSingleton().createManual("GlobalMapOverlay", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+            Ogre::TEX_TYPE_2D, mWidth, mHeight, 0, Ogre::PF_A8B8G8R8, Ogre::TU_DYNAMIC, this);
+
+        clear();
+
+        loadingListener->loadingOff();
+    }
+
+    void GlobalMap::renderCellsNoThrow (std::vector<Ogre::uchar>& data, int firstColumn, int step,
+        std::string& error) const
+    {
+        try
+        {
+            renderCells (data, firstColumn, step);
+        }
+        catch (const std::exception& e)
+        {
+            error = std::string ("failed to render the global map: ") + e.what();
+        }
+        catch (...)
+        {
+            error = "failed to render the global map: unknown error";
+        }
+    }
+
+    void GlobalMap::renderCells (std::vector<Ogre::uchar>& data, int firstColumn, int step) const
+    {
+        const MWWorld::ESMStore &esmStore =
+            MWBase::Environment::get().getWorld()->getStore();
+
+        for (int x = mMinX + firstColumn; x <= mMaxX; x += step)
         {
             for (int y = mMinY; y <= mMaxY; ++y)
             {
                 ESM::Land* land = esmStore.get<ESM::Land>().search (x,y);
 
-                if (land)
-                {
-                    int mask = ESM::Land::DATA_WNAM;
-                    if (!land->isDataLoaded(mask))
-                        land->loadData(mask);
-                }
+                // Terrain or the cell preloader may be using the same land, so only unload what
+                // was loaded here
+                const int mask = ESM::Land::DATA_WNAM;
+                bool loaded = land && land->loadData(mask);
 
                 for (int cellY=0; cellY<mCellSize; ++cellY)
                 {
@@ -133,26 +220,87 @@ namespace MWRender
                         data[texelY * mWidth * 3 + texelX * 3+2] = b;
                     }
                 }
-                loadingListener->increaseProgress();
-                if (land)
-                    land->unloadData();
+                if (loaded)
+                    land->unloadData(mask);
             }
         }
+    }
 
-        Ogre::DataStreamPtr stream(new Ogre::MemoryDataStream(&data[0], data.size()));
+    std::size_t GlobalMap::getCacheKey() const
+    {
+        std::size_t key = 0;
 
-        tex = Ogre::TextureManager::getSingleton ().createManual ("GlobalMap.png", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-            Ogre::TEX_TYPE_2D, mWidth, mHeight, 0, Ogre::PF_B8G8R8, Ogre::TU_STATIC);
-        tex->loadRawData(stream, mWidth, mHeight, Ogre::PF_B8G8R8);
+        boost::hash_combine (key, cacheVersion);
+        boost::hash_combine (key, mCellSize);
+        boost::hash_combine (key, mMinX);
+        boost::hash_combine (key, mMaxX);
+        boost::hash_combine (key, mMinY);
+        boost::hash_combine (key, mMaxY);
 
-        tex->load();
+        // Load order, including size and modification time, so edited content files are noticed
+        const std::vector<ESM::ESMReader>& readers = MWBase::Environment::get().getWorld()->getEsmReader();
 
-        mOverlayTexture = Ogre::TextureManager::getSingleton().createManual("GlobalMapOverlay", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
-            Ogre::TEX_TYPE_2D, mWidth, mHeight, 0, Ogre::PF_A8B8G8R8, Ogre::TU_DYNAMIC, this);
+        for (std::vector<ESM::ESMReader>::const_iterator iter (readers.begin()); iter!=readers.end(); ++iter)
+        {
+            std::string name = iter->getName();
+            boost::hash_combine (key, name);
 
-        clear();
+            boost::system::error_code error;
+            boost::uintmax_t size = boost::filesystem::file_size (name, error);
+            if (!error)
+                boost::hash_combine (key, static_cast<std::size_t> (size));
 
-        loadingListener->loadingOff();
+            std::time_t time = boost::filesystem::last_write_time (name, error);
+            if (!error)
+                boost::hash_combine (key, static_cast<std::size_t> (time));
+        }
+
+        return key;
+    }
+
+    bool GlobalMap::readCache (std::size_t key, std::vector<Ogre::uchar>& data) const
+    {
+        if (mCacheDir.empty())
+            return false;
+
+        boost::filesystem::ifstream stream (boost::filesystem::path (mCacheDir) / cacheFileName,
+            std::ios::binary);
+
+        if (!stream.is_open())
+            return false;
+
+        std::size_t storedKey = 0;
+        stream.read (reinterpret_cast<char *> (&storedKey), sizeof (storedKey));
+
+        if (!stream.good() || storedKey!=key)
+            return false;
+
+        stream.read (reinterpret_cast<char *> (&data[0]), data.size());
+
+        return stream.good() && static_cast<std::size_t> (stream.gcount())==data.size();
+    }
+
+    void GlobalMap::writeCache (std::size_t key, const std::vector<Ogre::uchar>& data) const
+    {
+        if (mCacheDir.empty())
+            return;
+
+        boost::system::error_code error;
+        boost::filesystem::create_directories (mCacheDir, error);
+
+        boost::filesystem::path path = boost::filesystem::path (mCacheDir) / cacheFileName;
+
+        boost::filesystem::ofstream stream (path, std::ios::binary | std::ios::trunc);
+
+        stream.write (reinterpret_cast<const char *> (&key), sizeof (key));
+        stream.write (reinterpret_cast<const char *> (&data[0]), data.size());
+
+        if (!stream.good())
+        {
+            std::cerr << "failed to write global map cache " << path.string() << std::endl;
+            stream.close();
+            boost::filesystem::remove (path);
+        }
     }
 
     void GlobalMap::worldPosToImageSpace(float x, float z, float& imageX, float& imageY)
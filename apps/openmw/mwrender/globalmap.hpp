@@ -2,6 +2,7 @@
 #define GAME_RENDER_GLOBALMAP_H
 
 #include <string>
+#include <vector>
 
 #include <OgreTexture.h>
 
@@ -46,6 +47,24 @@ namespace MWRender
         void read (ESM::GlobalMap& map);
 
     private:
+        std::size_t getCacheKey() const;
+        ///< Hash of everything the generated map image depends on (load order, bounds, cell size).
+
+        bool readCache (std::size_t key, std::vector<Ogre::uchar>& data) const;
+        ///< \return Was a valid cache for \a key found?
+
+        void writeCache (std::size_t key, const std::vector<Ogre::uchar>& data) const;
+
+        void renderCells (std::vector<Ogre::uchar>& data, int firstColumn, int step) const;
+        ///< Render every \a step th column of cells, starting with \a firstColumn.
+        ///
+        /// \note May be called from several threads at once, as long as their columns do not overlap.
+
+        void renderCellsNoThrow (std::vector<Ogre::uchar>& data, int firstColumn, int step,
+            std::string& error) const;
+        ///< Like renderCells, but store the message of an exception in \a error, so it can be
+        /// rethrown once all threads are joined.
+
         std::string mCacheDir;
 
         int mCellSize;
@@ -91,21 +91,14 @@ void LocalMap::saveFogOfWar(MWWorld::CellStore* cell)
 {
     if (!mInterior)
     {
-        std::string textureName = "Cell_"+coordStr(cell->getCell()->getGridX(), cell->getCell()->getGridY())+"_fog";
-        std::auto_ptr<ESM::FogState> fog (new ESM::FogState());
-        fog->mFogTextures.push_back(ESM::FogTexture());
-
-        TexturePtr tex = TextureManager::getSingleton().getByName(textureName);
-        if (tex.isNull())
+        std::string texturePrefix = "Cell_"+coordStr(cell->getCell()->getGridX(), cell->getCell()->getGridY());
+        if (mBuffers.find(texturePrefix) == mBuffers.end())
             return;
 
-        Ogre::Image image;
-        tex->load();
-        tex->convertToImage(image);
+        std::auto_ptr<ESM::FogState> fog (new ESM::FogState());
+        fog->mFogTextures.push_back(ESM::FogTexture());
 
-        Ogre::DataStreamPtr encoded = image.encode("tga");
-        fog->mFogTextures.back().mImageData.resize(encoded->size());
-        encoded->read(&fog->mFogTextures.back().mImageData[0], encoded->size());
+        saveFogOfWar(texturePrefix, fog->mFogTextures.back());
 
         cell->setFog(fog.release());
     }
@@ -133,21 +126,13 @@ void LocalMap::saveFogOfWar(MWWorld::CellStore* cell)
         {
             for (int y=0; y<segsY; ++y)
             {
-                std::string textureName = cell->getCell()->mName + "_" + coordStr(x,y) + "_fog";
-
-                TexturePtr tex = TextureManager::getSingleton().getByName(textureName);
-                if (tex.isNull())
+                std::string texturePrefix = cell->getCell()->mName + "_" + coordStr(x,y);
+                if (mBuffers.find(texturePrefix) == mBuffers.end())
                     return;
 
-                Ogre::Image image;
-                tex->load();
-                tex->convertToImage(image);
-
                 fog->mFogTextures.push_back(ESM::FogTexture());
 
-                Ogre::DataStreamPtr encoded = image.encode("tga");
-                fog->mFogTextures.back().mImageData.resize(encoded->size());
-                encoded->read(&fog->mFogTextures.back().mImageData[0], encoded->size());
+                saveFogOfWar(texturePrefix, fog->mFogTextures.back());
 
                 fog->mFogTextures.back().mX = x;
                 fog->mFogTextures.back().mY = y;
@@ -319,18 +304,30 @@ void LocalMap::createFogOfWar(const std::string& texturePrefix)
     const std::string texName = texturePrefix + "_fog";
     TexturePtr tex = createFogOfWarTexture(texName);
 
-    // create a buffer to use for dynamic operations
-    std::vector<uint32> buffer;
-
-    // initialize to (0, 0, 0, 1)
-    buffer.resize(sFogOfWarResolution*sFogOfWarResolution, 0xFF000000);
+    // create a buffer to use for dynamic operations, initialized to fully opaque
+    std::vector<uint8>& buffer = mBuffers[texturePrefix];
+    buffer.assign(sFogOfWarResolution*sFogOfWarResolution, 0xFF);
 
     // upload to the texture
     tex->load();
-    memcpy(tex->getBuffer()->lock(HardwareBuffer::HBL_DISCARD), &buffer[0], sFogOfWarResolution*sFogOfWarResolution*4);
-    tex->getBuffer()->unlock();
+    uploadFogOfWar(tex, buffer, Image::Box(0, 0, sFogOfWarResolution, sFogOfWarResolution));
+}
+
+void LocalMap::uploadFogOfWar(Ogre::TexturePtr tex, const std::vector<Ogre::uint8>& buffer, const Ogre::Image::Box& box)
+{
+    std::vector<uint32> data;
+    data.reserve(box.getWidth()*box.getHeight());
+
+    for (size_t texV = box.top; texV<box.bottom; ++texV)
+        for (size_t texU = box.left; texU<box.right; ++texU)
+            data.push_back(static_cast<uint32>(buffer[texV * sFogOfWarResolution + texU]) << 24);
+
+    tex->getBuffer()->blitFromMemory(PixelBox(box.getWidth(), box.getHeight(), 1, PF_A8R8G8B8, &data[0]), box);
+}
 
-    mBuffers[texturePrefix] = buffer;
+void LocalMap::saveFogOfWar(const std::string& texturePrefix, ESM::FogTexture& esm)
+{
+    esm.mAlpha = mBuffers[texturePrefix];
 }
 
 Ogre::TexturePtr LocalMap::createFogOfWarTexture(const std::string &texName)
@@ -355,6 +352,21 @@ Ogre::TexturePtr LocalMap::createFogOfWarTexture(const std::string &texName)
 
 void LocalMap::loadFogOfWar (const std::string& texturePrefix, ESM::FogTexture& esm)
 {
+    if (!esm.mAlpha.empty())
+    {
+        if (int(esm.mAlpha.size()) != sFogOfWarResolution*sFogOfWarResolution)
+            throw std::runtime_error("fog texture size mismatch");
+
+        TexturePtr tex = createFogOfWarTexture(texturePrefix + "_fog");
+
+        mBuffers[texturePrefix] = esm.mAlpha;
+
+        tex->load();
+        uploadFogOfWar(tex, esm.mAlpha, Image::Box(0, 0, sFogOfWarResolution, sFogOfWarResolution));
+        return;
+    }
+
+    // older saved games store a TGA image
     std::vector<char>& data = esm.mImageData;
     Ogre::DataStreamPtr stream(new Ogre::MemoryDataStream(&data[0], data.size()));
     Ogre::Image image;
@@ -371,11 +383,14 @@ void LocalMap::loadFogOfWar (const std::string& texturePrefix, ESM::FogTexture&
     tex->loadImage(image);
 
     // create a buffer to use for dynamic operations
-    std::vector<uint32> buffer;
-    buffer.resize(sFogOfWarResolution*sFogOfWarResolution);
-    memcpy(&buffer[0], image.getData(), image.getSize());
-
-    mBuffers[texturePrefix] = buffer;
+    std::vector<uint32> pixels;
+    pixels.resize(sFogOfWarResolution*sFogOfWarResolution);
+    memcpy(&pixels[0], image.getData(), image.getSize());
+
+    std::vector<uint8>& buffer = mBuffers[texturePrefix];
+    buffer.resize(pixels.size());
+    for (size_t i=0; i<pixels.size(); ++i)
+        buffer[i] = static_cast<uint8>(pixels[i] >> 24);
 }
 
 void LocalMap::render(const float x, const float y,
@@ -471,8 +486,7 @@ bool LocalMap::isPositionExplored (float nX, float nY, int x, int y, bool interi
     int texU = static_cast<int>((sFogOfWarResolution - 1) * nX);
     int texV = static_cast<int>((sFogOfWarResolution - 1) * nY);
 
-    Ogre::uint32 clr = mBuffers[texName][texV * sFogOfWarResolution + texU];
-    uint8 alpha = (clr >> 24);
+    uint8 alpha = mBuffers[texName][texV * sFogOfWarResolution + texU];
     return alpha < 200;
 }
 
@@ -484,19 +498,20 @@ void LocalMap::loadResource(Ogre::Resource* resource)
         resourceName = resourceName.substr(0, pos);
     if (mBuffers.find(resourceName) == mBuffers.end())
     {
-        // create a buffer to use for dynamic operations
-        std::vector<uint32> buffer;
-
-        // initialize to (0, 0, 0, 1)
-        buffer.resize(sFogOfWarResolution*sFogOfWarResolution, 0xFF000000);
-        mBuffers[resourceName] = buffer;
+        // create a buffer to use for dynamic operations, initialized to fully opaque
+        mBuffers[resourceName].assign(sFogOfWarResolution*sFogOfWarResolution, 0xFF);
     }
 
-    std::vector<uint32>& buffer = mBuffers[resourceName];
+    std::vector<uint8>& buffer = mBuffers[resourceName];
 
     Ogre::Texture* tex = static_cast<Ogre::Texture*>(resource);
     tex->createInternalResources();
-    memcpy(tex->getBuffer()->lock(HardwareBuffer::HBL_DISCARD), &buffer[0], sFogOfWarResolution*sFogOfWarResolution*4);
+
+    std::vector<uint32> pixels (buffer.size());
+    for (size_t i=0; i<buffer.size(); ++i)
+        pixels[i] = static_cast<uint32>(buffer[i]) << 24;
+
+    memcpy(tex->getBuffer()->lock(HardwareBuffer::HBL_DISCARD), &pixels[0], sFogOfWarResolution*sFogOfWarResolution*4);
     tex->getBuffer()->unlock();
 }
 
@@ -574,36 +589,53 @@ void LocalMap::updatePlayer (const Ogre::Vector3& position, const Ogre::Quaterni
             TexturePtr tex = TextureManager::getSingleton().getByName(texName+"_fog");
             if (!tex.isNull())
             {
-                std::map <std::string, std::vector<Ogre::uint32> >::iterator anIter;
+                std::map <std::string, std::vector<Ogre::uint8> >::iterator anIter;
 
                 // get its buffer
                 anIter = mBuffers.find(texName);
                 if (anIter == mBuffers.end()) return;
 
-                std::vector<Ogre::uint32>& aBuffer = (*anIter).second;
-                int i=0;
-                for (int texV = 0; texV<sFogOfWarResolution; ++texV)
+                std::vector<Ogre::uint8>& aBuffer = (*anIter).second;
+
+                // player position in the texel space of this texture
+                float centerU = u*(sFogOfWarResolution-1) - mx*(sFogOfWarResolution-1);
+                float centerV = v*(sFogOfWarResolution-1) - my*(sFogOfWarResolution-1);
+
+                // only texels inside the explore radius can change
+                int minU = std::max(0, static_cast<int>(std::floor(centerU - exploreRadius)));
+                int maxU = std::min(sFogOfWarResolution-1, static_cast<int>(std::ceil(centerU + exploreRadius)));
+                int minV = std::max(0, static_cast<int>(std::floor(centerV - exploreRadius)));
+                int maxV = std::min(sFogOfWarResolution-1, static_cast<int>(std::ceil(centerV + exploreRadius)));
+
+                // bounds of the changed texels
+                int dirtyLeft = sFogOfWarResolution, dirtyTop = sFogOfWarResolution, dirtyRight = -1, dirtyBottom = -1;
+
+                for (int texV = minV; texV<=maxV; ++texV)
                 {
-                    for (int texU = 0; texU<sFogOfWarResolution; ++texU)
+                    for (int texU = minU; texU<=maxU; ++texU)
                     {
-                        float sqrDist = Math::Sqr((texU + mx*(sFogOfWarResolution-1)) - u*(sFogOfWarResolution-1))
-                                + Math::Sqr((texV + my*(sFogOfWarResolution-1)) - v*(sFogOfWarResolution-1));
-                        uint32 clr = aBuffer[i];
-                        uint8 alpha = (clr >> 24);
-                        alpha = std::min( alpha, (uint8) (std::max(0.f, std::min(1.f, (sqrDist/sqrExploreRadius)))*255) );
-                        aBuffer[i] = (uint32) (alpha << 24);
-
-                        ++i;
+                        float sqrDist = Math::Sqr(texU - centerU) + Math::Sqr(texV - centerV);
+                        uint8& alpha = aBuffer[texV * sFogOfWarResolution + texU];
+                        uint8 newAlpha = std::min( alpha, (uint8) (std::max(0.f, std::min(1.f, (sqrDist/sqrExploreRadius)))*255) );
+
+                        if (newAlpha != alpha)
+                        {
+                            alpha = newAlpha;
+                            dirtyLeft = std::min(dirtyLeft, texU);
+                            dirtyRight = std::max(dirtyRight, texU);
+                            dirtyTop = std::min(dirtyTop, texV);
+                            dirtyBottom = std::max(dirtyBottom, texV);
+                        }
                     }
                 }
 
+                if (dirtyRight < 0)
+                    continue; // nothing new explored
+
                 tex->load();
 
-                // copy to the texture
-                // NOTE: Could be optimized later. We actually only need to update the region that changed.
-                // Not a big deal at the moment, the FoW is only 32x32 anyway.
-                memcpy(tex->getBuffer()->lock(HardwareBuffer::HBL_DISCARD), &aBuffer[0], sFogOfWarResolution*sFogOfWarResolution*4);
-                tex->getBuffer()->unlock();
+                // copy the changed region to the texture
+                uploadFogOfWar(tex, aBuffer, Image::Box(dirtyLeft, dirtyTop, dirtyRight+1, dirtyBottom+1));
             }
         }
     }
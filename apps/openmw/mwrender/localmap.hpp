@@ -6,6 +6,7 @@
 #include <OgreAxisAlignedBox.h>
 #include <OgreColourValue.h>
 #include <OgreResource.h>
+#include <OgreImage.h>
 
 namespace MWWorld
 {
@@ -123,11 +124,16 @@ namespace MWRender
 
         Ogre::TexturePtr createFogOfWarTexture(const std::string& name);
 
+        /// Copy the texels in \a box of the alpha buffer \a buffer into \a tex.
+        void uploadFogOfWar(Ogre::TexturePtr tex, const std::vector<Ogre::uint8>& buffer, const Ogre::Image::Box& box);
+
+        void saveFogOfWar(const std::string& texturePrefix, ESM::FogTexture& esm);
+
         std::string coordStr(const int x, const int y);
 
-        // A buffer for the "fog of war" textures of the current cell.
+        // A buffer for the "fog of war" textures of the current cell, holding one alpha value per texel.
         // Both interior and exterior maps are possibly divided into multiple textures.
-        std::map <std::string, std::vector<Ogre::uint32> > mBuffers;
+        std::map <std::string, std::vector<Ogre::uint8> > mBuffers;
 
         // The render texture we will use to create the map images
         Ogre::TexturePtr mRenderTexture;
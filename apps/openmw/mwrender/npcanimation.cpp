@@ -1,5 +1,7 @@
 #include "npcanimation.hpp"
 
+#include <sstream>
+
 #include <OgreSceneManager.h>
 #include <OgreEntity.h>
 #include <OgreParticleSystem.h>
@@ -208,6 +210,7 @@ NpcAnimation::~NpcAnimation()
 NpcAnimation::NpcAnimation(const MWWorld::Ptr& ptr, Ogre::SceneNode* node, int visibilityFlags, bool disableListener, bool disableSounds, ViewMode viewMode)
   : Animation(ptr, node),
     mListenerDisabled(disableListener),
+    mRecycleParts(false),
     mViewMode(viewMode),
     mShowWeapons(false),
     mShowCarriedLeft(true),
@@ -345,6 +348,7 @@ void NpcAnimation::updateParts()
     if (!mSkelBase)
         return;
 
+    bool wasOpaque = (mAlpha == 1.f);
     mAlpha = 1.f;
     const MWWorld::Class &cls = mPtr.getClass();
 
@@ -361,6 +365,11 @@ void NpcAnimation::updateParts()
         return;
     }
 
+    // An equipment change usually leaves most parts as they are. Parts are removed and added
+    // again below, so keep the removed ones around instead of loading them again. Parts made
+    // transparent by setAlpha would need their materials restored and are not kept.
+    mRecycleParts = wasOpaque;
+
     static const struct {
         int mSlot;
         int mBasePriority;
@@ -441,7 +450,10 @@ void NpcAnimation::updateParts()
             addOrReplaceIndividualPart(ESM::PRT_Hair, -1,1, mHairModel);
     }
     if(mViewMode == VM_HeadOnly)
+    {
+        discardRecycledParts();
         return;
+    }
 
     if(mPartPriorities[ESM::PRT_Shield] < 1)
     {
@@ -580,6 +592,8 @@ void NpcAnimation::updateParts()
         }
     }
 
+    discardRecycledParts();
+
     if (wasArrowAttached)
         attachArrow();
 }
@@ -680,12 +694,38 @@ Ogre::Vector3 NpcAnimation::runAnimation(float timepassed)
     return ret;
 }
 
+std::string NpcAnimation::getPartKey(const std::string &mesh, int group, bool enchantedGlow, const Ogre::Vector3* glowColor)
+{
+    std::ostringstream stream;
+    stream << Misc::StringUtils::lowerCase(mesh) << '|' << group;
+    if (enchantedGlow && glowColor)
+        stream << '|' << glowColor->x << ',' << glowColor->y << ',' << glowColor->z;
+    return stream.str();
+}
+
+void NpcAnimation::discardRecycledParts()
+{
+    mRecycleParts = false;
+    for(size_t i = 0;i < ESM::PRT_Count;i++)
+    {
+        mRecycledParts[i].setNull();
+        mRecycledKeys[i].clear();
+    }
+}
+
 void NpcAnimation::removeIndividualPart(ESM::PartReferenceType type)
 {
     mPartPriorities[type] = 0;
     mPartslots[type] = -1;
 
+    // Lights are added to the part by the caller, which would add them a second time
+    if (mRecycleParts && !mObjectParts[type].isNull() && mObjectParts[type]->mLights.empty())
+    {
+        mRecycledParts[type] = mObjectParts[type];
+        mRecycledKeys[type] = mPartKeys[type];
+    }
     mObjectParts[type].setNull();
+    mPartKeys[type].clear();
     if (!mSoundIds[type].empty() && !mSoundsDisabled)
     {
         MWBase::Environment::get().getSoundManager()->stopSound3D(mPtr, mSoundIds[type]);
@@ -717,21 +757,42 @@ bool NpcAnimation::addOrReplaceIndividualPart(ESM::PartReferenceType type, int g
     if(priority <= mPartPriorities[type])
         return false;
 
+    // Taken before removing the current part, which may be recycled in its place
+    std::string key = getPartKey(mesh, group, enchantedGlow, glowColor);
+    NifOgre::ObjectScenePtr recycledPart;
+    if (mRecycledKeys[type] == key)
+    {
+        recycledPart = mRecycledParts[type];
+        mRecycledParts[type].setNull();
+        mRecycledKeys[type].clear();
+    }
+    bool recycled = !recycledPart.isNull();
+
     removeIndividualPart(type);
     mPartslots[type] = group;
     mPartPriorities[type] = priority;
-    try
+
+    if (recycled)
     {
-        const std::string& bonename = sPartList.at(type);
-        // PRT_Hair seems to be the only type that breaks consistency and uses a filter that's different from the attachment bone
-        const std::string bonefilter = (type == ESM::PRT_Hair) ? "hair" : bonename;
-        mObjectParts[type] = insertBoundedPart(mesh, group, bonename, bonefilter, enchantedGlow, glowColor);
+        // Still attached to the skeleton and set up, see updateParts
+        mObjectParts[type] = recycledPart;
     }
-    catch (std::exception& e)
+    else
     {
-        std::cerr << "Error adding NPC part: " << e.what() << std::endl;
-        return false;
+        try
+        {
+            const std::string& bonename = sPartList.at(type);
+            // PRT_Hair seems to be the only type that breaks consistency and uses a filter that's different from the attachment bone
+            const std::string bonefilter = (type == ESM::PRT_Hair) ? "hair" : bonename;
+            mObjectParts[type] = insertBoundedPart(mesh, group, bonename, bonefilter, enchantedGlow, glowColor);
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Error adding NPC part: " << e.what() << std::endl;
+            return false;
+        }
     }
+    mPartKeys[type] = key;
 
     if (!mSoundsDisabled)
     {
@@ -750,7 +811,7 @@ bool NpcAnimation::addOrReplaceIndividualPart(ESM::PartReferenceType type, int g
     if(mObjectParts[type]->mSkelBase)
     {
         Ogre::SkeletonInstance *skel = mObjectParts[type]->mSkelBase->getSkeleton();
-        if(mObjectParts[type]->mSkelBase->isParentTagPoint())
+        if(!recycled && mObjectParts[type]->mSkelBase->isParentTagPoint())
         {
             Ogre::Node *root = mObjectParts[type]->mSkelBase->getParentNode();
             if(skel->hasBone("BoneOffset"))
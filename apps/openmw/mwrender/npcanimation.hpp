@@ -71,6 +71,12 @@ private:
     // Bounded Parts
     NifOgre::ObjectScenePtr mObjectParts[ESM::PRT_Count];
     std::string mSoundIds[ESM::PRT_Count];
+    std::string mPartKeys[ESM::PRT_Count]; // model, group and glow of each part, see getPartKey
+
+    // Parts removed during updateParts(), put back if they are added again unchanged
+    bool mRecycleParts;
+    NifOgre::ObjectScenePtr mRecycledParts[ESM::PRT_Count];
+    std::string mRecycledKeys[ESM::PRT_Count];
 
     const ESM::NPC *mNpc;
     std::string    mHeadModel;
@@ -109,6 +115,10 @@ private:
                                               const std::string &bonefilter,
                                           bool enchantedGlow, Ogre::Vector3* glowColor=NULL);
 
+    static std::string getPartKey(const std::string &mesh, int group, bool enchantedGlow, const Ogre::Vector3* glowColor);
+
+    void discardRecycledParts();
+
     void removeIndividualPart(ESM::PartReferenceType type);
     void reserveIndividualPart(ESM::PartReferenceType type, int group, int priority);
 
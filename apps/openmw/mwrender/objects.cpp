@@ -17,6 +17,8 @@
 #include <components/nifogre/ogrenifloader.hpp>
 #include <components/settings/settings.hpp>
 
+#include <openengine/ogre/lights.hpp>
+
 #include "../mwworld/ptr.hpp"
 #include "../mwworld/class.hpp"
 #include "../mwworld/cellstore.hpp"
@@ -26,6 +28,20 @@
 
 using namespace MWRender;
 
+namespace
+{
+    void buildGeometry(Ogre::StaticGeometry* sg)
+    {
+        sg->build();
+
+        OEngine::Render::LightManager& lightManager = OEngine::Render::LightManager::getInstance();
+
+        Ogre::StaticGeometry::RegionIterator it = sg->getRegionIterator();
+        while (it.hasMoreElements())
+            lightManager.addObject(it.getNext());
+    }
+}
+
 int Objects::uniqueID = 0;
 
 void Objects::setRootNode(Ogre::SceneNode* root)
@@ -86,8 +102,11 @@ void Objects::insertModel(const MWWorld::Ptr &ptr, const std::string &mesh, bool
         extents *= ptr.getRefData().getBaseNode()->getScale();
         float size = std::max(std::max(extents.x, extents.y), extents.z);
 
-        bool small = (size < Settings::Manager::getInt("small object size", "Viewing distance")) &&
-                     Settings::Manager::getBool("limit small object distance", "Viewing distance");
+        static const Settings::IntValue smallObjectSize("small object size", "Viewing distance");
+        static const Settings::BoolValue limitSmallObjectDistance("limit small object distance", "Viewing distance");
+        static const Settings::BoolValue useStaticGeometry("use static geometry", "Objects");
+
+        bool small = (size < smallObjectSize.get()) && limitSmallObjectDistance.get();
         // do not fade out doors. that will cause holes and look stupid
         if(ptr.getTypeName().find("Door") != std::string::npos)
             small = false;
@@ -97,7 +116,7 @@ void Objects::insertModel(const MWWorld::Ptr &ptr, const std::string &mesh, bool
         mBounds[ptr.getCell()].merge(bounds);
 
         if(batch &&
-           Settings::Manager::getBool("use static geometry", "Objects") &&
+           useStaticGeometry.get() &&
            anim->canBatch())
         {
             Ogre::StaticGeometry* sg = 0;
@@ -222,13 +241,11 @@ void Objects::buildStaticGeometry(MWWorld::CellStore& cell)
 {
     if(mStaticGeometry.find(&cell) != mStaticGeometry.end())
     {
-        Ogre::StaticGeometry* sg = mStaticGeometry[&cell];
-        sg->build();
+        buildGeometry(mStaticGeometry[&cell]);
     }
     if(mStaticGeometrySmall.find(&cell) != mStaticGeometrySmall.end())
     {
-        Ogre::StaticGeometry* sg = mStaticGeometrySmall[&cell];
-        sg->build();
+        buildGeometry(mStaticGeometrySmall[&cell]);
     }
 }
 
@@ -254,13 +271,13 @@ void Objects::rebuildStaticGeometry()
     for (std::map<MWWorld::CellStore *, Ogre::StaticGeometry*>::iterator it = mStaticGeometry.begin(); it != mStaticGeometry.end(); ++it)
     {
         it->second->destroy();
-        it->second->build();
+        buildGeometry(it->second);
     }
 
     for (std::map<MWWorld::CellStore *, Ogre::StaticGeometry*>::iterator it = mStaticGeometrySmall.begin(); it != mStaticGeometrySmall.end(); ++it)
     {
         it->second->destroy();
-        it->second->build();
+        buildGeometry(it->second);
     }
 }
 
@@ -20,6 +20,7 @@
 #include <extern/shiny/Platforms/Ogre/OgrePlatform.hpp>
 
 #include <openengine/bullet/physic.hpp>
+#include <openengine/ogre/lights.hpp>
 
 #include <components/settings/settings.hpp>
 #include <components/terrain/defaultworld.hpp>
@@ -61,11 +62,14 @@ RenderingManager::RenderingManager(OEngine::Render::OgreRenderer& _rend, const b
     , mTerrain(NULL)
     , mRendering(_rend)
     , mEffectManager(NULL)
+    , mLightManager(NULL)
     , mPlayerAnimation(NULL)
     , mAmbientMode(0)
     , mPhysicsEngine(engine)
     , mRenderWorld(true)
 {
+    mLightManager = new OEngine::Render::LightManager(mRendering.getScene(),
+        std::max(Settings::Manager::getInt("num lights", "Objects"), 1));
     mActors = new MWRender::Actors(mRendering, this);
     mObjects = new MWRender::Objects(mRendering);
     mEffectManager = new EffectManager(mRendering.getScene());
@@ -194,6 +198,7 @@ RenderingManager::~RenderingManager ()
     delete mActors;
     delete mObjects;
     delete mEffectManager;
+    delete mLightManager;
     delete mFactory;
 }
 
@@ -249,11 +254,15 @@ void RenderingManager::cellAdded (MWWorld::CellStore *store)
     if (store->isExterior())
         mTerrain->loadCell(store->getCell()->getGridX(), store->getCell()->getGridY());
 
-    mObjects->buildStaticGeometry (*store);
-    sh::Factory::getInstance().unloadUnreferencedMaterials();
     mDebugging->cellAdded(store);
 }
 
+void RenderingManager::buildStaticGeometry (MWWorld::CellStore& cell)
+{
+    mObjects->buildStaticGeometry (cell);
+    sh::Factory::getInstance().unloadUnreferencedMaterials();
+}
+
 void RenderingManager::addObject (const MWWorld::Ptr& ptr, const std::string& model){
     const MWWorld::Class& class_ =
             ptr.getClass();
@@ -396,6 +405,9 @@ void RenderingManager::update (float duration, bool paused)
     Ogre::Quaternion orient = node->_getDerivedOrientation();
     mLocalMap->updatePlayer(playerPos, orient);
 
+    // lights keep flickering while a menu is open
+    mLightManager->update(duration);
+
     if(paused)
         return;
 
@@ -1005,11 +1017,6 @@ void RenderingManager::removeWaterRippleEmitter (const MWWorld::Ptr& ptr)
     mWater->removeEmitter (ptr);
 }
 
-void RenderingManager::updateWaterRippleEmitterPtr (const MWWorld::Ptr& old, const MWWorld::Ptr& ptr)
-{
-    mWater->updateEmitterPtr(old, ptr);
-}
-
 void RenderingManager::frameStarted(float dt, bool paused)
 {
     if (mTerrain)
@@ -38,6 +38,14 @@ namespace Terrain
     class World;
 }
 
+namespace OEngine
+{
+    namespace Render
+    {
+        class LightManager;
+    }
+}
+
 namespace MWRender
 {
     class Shadows;
@@ -101,6 +109,9 @@ public:
     /// when rebatching is needed and update automatically at the end of each frame.
     void cellAdded (MWWorld::CellStore *store);
 
+    /// Batch the static objects of a cell; call after all of its objects were added.
+    void buildStaticGeometry (MWWorld::CellStore& cell);
+
     /// Clear all savegame-specific data (i.e. fog of war textures)
     void clear();
 
@@ -173,7 +184,6 @@ public:
 
     void addWaterRippleEmitter (const MWWorld::Ptr& ptr, float scale = 1.f, float force = 1.f);
     void removeWaterRippleEmitter (const MWWorld::Ptr& ptr);
-    void updateWaterRippleEmitterPtr (const MWWorld::Ptr& old, const MWWorld::Ptr& ptr);
 
     void updateTerrain ();
     ///< update the terrain according to the player position. Usually done automatically, but should be done manually
@@ -246,6 +256,8 @@ private:
 
     MWRender::EffectManager* mEffectManager;
 
+    OEngine::Render::LightManager* mLightManager;
+
     MWRender::NpcAnimation *mPlayerAnimation;
 
     // 0 normal, 1 more bright, 2 max
@@ -1,6 +1,7 @@
 #include "ripplesimulation.hpp"
 
 #include <stdexcept>
+#include <limits>
 
 #include <OgreSceneNode.h>
 #include <OgreSceneManager.h>
@@ -13,6 +14,7 @@
 #include "../mwbase/world.hpp"
 
 #include "../mwworld/fallback.hpp"
+#include "../mwworld/cellstore.hpp"
 
 #include "renderconst.hpp"
 
@@ -66,93 +68,168 @@ RippleSimulation::~RippleSimulation()
 
 void RippleSimulation::update(float dt, Ogre::Vector2 position)
 {
-    bool newParticle = false;
-    for (std::vector<Emitter>::iterator it=mEmitters.begin(); it !=mEmitters.end(); ++it)
+    const MWWorld::ObjectHandleTable& handles = MWWorld::ObjectHandleTable::get();
+
+    mPositions.resize(mHandles.size());
+    mWaterLevels.resize(mHandles.size());
+
+    for (size_t i = 0; i < mHandles.size(); )
     {
-        if (it->mPtr == MWBase::Environment::get().getWorld ()->getPlayerPtr())
+        MWWorld::Ptr ptr = handles.getPtr(mHandles[i]);
+
+        if (ptr.isEmpty())
         {
-            // fetch a new ptr (to handle cell change etc)
-            // for non-player actors this is done in updateObjectCell
-            it->mPtr = MWBase::Environment::get().getWorld ()->getPlayerPtr();
+            removeEmitter(i);
+            continue;
         }
-        Ogre::Vector3 currentPos (it->mPtr.getRefData().getPosition().pos);
-        currentPos.z = 0;
-        if ( (currentPos - it->mLastEmitPosition).length() > 10
-             // Only emit when close to the water surface, not above it and not too deep in the water
-            && MWBase::Environment::get().getWorld ()->isUnderwater (it->mPtr.getCell(),
-                Ogre::Vector3(it->mPtr.getRefData().getPosition().pos))
-             && !MWBase::Environment::get().getWorld()->isSubmerged(it->mPtr))
-        {
-            it->mLastEmitPosition = currentPos;
 
-            newParticle = true;
-            Ogre::Particle* created = mParticleSystem->createParticle();
-            if (!created)
-                break; // TODO: cleanup the oldest particle to make room
-#if OGRE_VERSION >= (1 << 16 | 10 << 8 | 0)
-            Ogre::Vector3& position = created->mPosition;
-            Ogre::Vector3& direction = created->mDirection;
-            Ogre::ColourValue& colour = created->mColour;
-            float& totalTimeToLive = created->mTotalTimeToLive;
-            float& timeToLive = created->mTimeToLive;
-            Ogre::Radian& rotSpeed = created->mRotationSpeed;
-            Ogre::Radian& rotation = created->mRotation;
-#else
-            Ogre::Vector3& position = created->position;
-            Ogre::Vector3& direction = created->direction;
-            Ogre::ColourValue& colour = created->colour;
-            float& totalTimeToLive = created->totalTimeToLive;
-            float& timeToLive = created->timeToLive;
-            Ogre::Radian& rotSpeed = created->rotationSpeed;
-            Ogre::Radian& rotation = created->rotation;
-#endif
-            timeToLive = totalTimeToLive = mRippleLifeTime;
-            colour = Ogre::ColourValue(0.f, 0.f, 0.f, 0.7f); // Water_RippleAlphas.x?
-            direction = Ogre::Vector3(0,0,0);
-            position = currentPos;
-            position.z = 0; // Z is set by the Scene Node
-            rotSpeed = mRippleRotSpeed;
-            rotation = Ogre::Radian(Ogre::Math::RangeRandom(-Ogre::Math::PI, Ogre::Math::PI));
-            created->setDimensions(mParticleSystem->getDefaultWidth(), mParticleSystem->getDefaultHeight());
-        }
+        mPositions[i] = Ogre::Vector3(ptr.getRefData().getPosition().pos);
+
+        const MWWorld::CellStore* cell = ptr.getCell();
+        mWaterLevels[i] = (cell->getCell()->mData.mFlags & ESM::Cell::HasWater) ?
+            cell->getWaterLevel() : -std::numeric_limits<float>::max();
+        ++i;
+    }
+
+    mPositions.resize(mHandles.size());
+    mWaterLevels.resize(mHandles.size());
+
+    findMovedEmitters();
+
+    // Actors standing still or out of the water are done with; only the depth test is left
+    MWBase::World* world = MWBase::Environment::get().getWorld();
+
+    bool newParticle = false;
+    for (size_t i = 0; i < mHandles.size(); ++i)
+    {
+        if (!mMoved[i])
+            continue;
+
+        MWWorld::Ptr ptr = handles.getPtr(mHandles[i]);
+
+        // Only emit when close to the water surface, not too deep in the water
+        if (world->isSubmerged(ptr))
+            continue;
+
+        mLastEmitPositions[i] = Ogre::Vector3(mPositions[i].x, mPositions[i].y, 0);
+
+        newParticle = true;
+        if (!emitRipple(mLastEmitPositions[i]))
+            break; // TODO: cleanup the oldest particle to make room
     }
 
     if (newParticle) // now apparently needs another update, otherwise it won't render in the first frame after a particle is created. TODO: patch Ogre to handle this better
         mParticleSystem->_update(0.f);
 }
 
+void RippleSimulation::findMovedEmitters()
+{
+    const size_t count = mPositions.size();
+
+    mMoved.resize(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        float x = mPositions[i].x - mLastEmitPositions[i].x;
+        float y = mPositions[i].y - mLastEmitPositions[i].y;
+
+        // Below the water surface, as World::isUnderwater would tell
+        mMoved[i] = x*x + y*y > 10*10 && mPositions[i].z < mWaterLevels[i];
+    }
+}
+
+bool RippleSimulation::emitRipple(const Ogre::Vector3& emitPosition)
+{
+    Ogre::Particle* created = mParticleSystem->createParticle();
+    if (!created)
+        return false;
+#if OGRE_VERSION >= (1 << 16 | 10 << 8 | 0)
+    Ogre::Vector3& position = created->mPosition;
+    Ogre::Vector3& direction = created->mDirection;
+    Ogre::ColourValue& colour = created->mColour;
+    float& totalTimeToLive = created->mTotalTimeToLive;
+    float& timeToLive = created->mTimeToLive;
+    Ogre::Radian& rotSpeed = created->mRotationSpeed;
+    Ogre::Radian& rotation = created->mRotation;
+#else
+    Ogre::Vector3& position = created->position;
+    Ogre::Vector3& direction = created->direction;
+    Ogre::ColourValue& colour = created->colour;
+    float& totalTimeToLive = created->totalTimeToLive;
+    float& timeToLive = created->timeToLive;
+    Ogre::Radian& rotSpeed = created->rotationSpeed;
+    Ogre::Radian& rotation = created->rotation;
+#endif
+    timeToLive = totalTimeToLive = mRippleLifeTime;
+    colour = Ogre::ColourValue(0.f, 0.f, 0.f, 0.7f); // Water_RippleAlphas.x?
+    direction = Ogre::Vector3(0,0,0);
+    position = emitPosition;
+    position.z = 0; // Z is set by the Scene Node
+    rotSpeed = mRippleRotSpeed;
+    rotation = Ogre::Radian(Ogre::Math::RangeRandom(-Ogre::Math::PI, Ogre::Math::PI));
+    created->setDimensions(mParticleSystem->getDefaultWidth(), mParticleSystem->getDefaultHeight());
+    return true;
+}
+
 void RippleSimulation::addEmitter(const MWWorld::Ptr& ptr, float scale, float force)
 {
-    Emitter newEmitter;
-    newEmitter.mPtr = ptr;
-    newEmitter.mScale = scale;
-    newEmitter.mForce = force;
-    newEmitter.mLastEmitPosition = Ogre::Vector3(0,0,0);
-    mEmitters.push_back (newEmitter);
+    MWWorld::ObjectHandle handle = MWWorld::ObjectHandleTable::get().getHandle(ptr);
+
+    if (handle.mIndex >= mEmitterIndices.size())
+        mEmitterIndices.resize(handle.mIndex+1, size_t(-1));
+
+    size_t& index = mEmitterIndices[handle.mIndex];
+
+    if (index == size_t(-1))
+    {
+        index = mHandles.size();
+        mHandles.push_back(handle);
+        mLastEmitPositions.push_back(Ogre::Vector3(0,0,0));
+        mScales.push_back(scale);
+        mForces.push_back(force);
+    }
+    else
+    {
+        // The object is added again, or the slot of a destroyed emitter was reused
+        mHandles[index] = handle;
+        mLastEmitPositions[index] = Ogre::Vector3(0,0,0);
+        mScales[index] = scale;
+        mForces[index] = force;
+    }
 }
 
 void RippleSimulation::removeEmitter (const MWWorld::Ptr& ptr)
 {
-    for (std::vector<Emitter>::iterator it = mEmitters.begin(); it != mEmitters.end(); ++it)
+    MWWorld::ObjectHandle handle = MWWorld::ObjectHandleTable::get().getHandle(ptr);
+
+    if (handle.mIndex < mEmitterIndices.size())
     {
-        if (it->mPtr == ptr)
-        {
-            mEmitters.erase(it);
-            return;
-        }
+        size_t index = mEmitterIndices[handle.mIndex];
+
+        if (index != size_t(-1) && mHandles[index] == handle)
+            removeEmitter(index);
     }
 }
 
-void RippleSimulation::updateEmitterPtr (const MWWorld::Ptr& old, const MWWorld::Ptr& ptr)
+void RippleSimulation::removeEmitter (size_t index)
 {
-    for (std::vector<Emitter>::iterator it = mEmitters.begin(); it != mEmitters.end(); ++it)
+    mEmitterIndices[mHandles[index].mIndex] = size_t(-1);
+
+    size_t last = mHandles.size()-1;
+    if (index != last)
     {
-        if (it->mPtr == old)
-        {
-            it->mPtr = ptr;
-            return;
-        }
+        mHandles[index] = mHandles[last];
+        mLastEmitPositions[index] = mLastEmitPositions[last];
+        mScales[index] = mScales[last];
+        mForces[index] = mForces[last];
+
+        mEmitterIndices[mHandles[index].mIndex] = index;
     }
+
+    mHandles.pop_back();
+    mLastEmitPositions.pop_back();
+    mScales.pop_back();
+    mForces.pop_back();
 }
 
 void RippleSimulation::setWaterHeight(float height)
@@ -4,6 +4,7 @@
 #include <OgreVector3.h>
 
 #include "../mwworld/ptr.hpp"
+#include "../mwworld/objecthandle.hpp"
 
 namespace Ogre
 {
@@ -19,14 +20,6 @@ namespace MWWorld
 namespace MWRender
 {
 
-struct Emitter
-{
-    MWWorld::Ptr mPtr;
-    Ogre::Vector3 mLastEmitPosition;
-    float mScale;
-    float mForce;
-};
-
 class RippleSimulation
 {
 public:
@@ -37,10 +30,9 @@ public:
     /// @param position Position of the player
     void update(float dt, Ogre::Vector2 position);
 
-    /// adds an emitter, position will be tracked automatically
+    /// adds an emitter, position will be tracked automatically, also across cell changes
     void addEmitter (const MWWorld::Ptr& ptr, float scale = 1.f, float force = 1.f);
     void removeEmitter (const MWWorld::Ptr& ptr);
-    void updateEmitterPtr (const MWWorld::Ptr& old, const MWWorld::Ptr& ptr);
 
     /// Change the height of the water surface, thus moving all ripples with it
     void setWaterHeight(float height);
@@ -49,11 +41,31 @@ public:
     void clear();
 
 private:
+    void removeEmitter (size_t index);
+
+    void findMovedEmitters();
+    ///< Find the emitters that are below the water surface and moved far enough from their last ripples
+
+    bool emitRipple (const Ogre::Vector3& position);
+    ///< \return false, if the particle system is full
+
     Ogre::SceneManager* mSceneMgr;
     Ogre::ParticleSystem* mParticleSystem;
     Ogre::SceneNode* mSceneNode;
 
-    std::vector<Emitter> mEmitters;
+    // Emitters, one entry per emitter. Emitters whose objects are destroyed are dropped on update.
+    std::vector<MWWorld::ObjectHandle> mHandles;
+    std::vector<Ogre::Vector3> mLastEmitPositions;
+    std::vector<float> mScales;
+    std::vector<float> mForces;
+
+    std::vector<size_t> mEmitterIndices; // by handle index, -1: no emitter
+
+    // Current positions and water levels of the emitters, and whether they moved far enough
+    // in the water to emit a ripple
+    std::vector<Ogre::Vector3> mPositions;
+    std::vector<float> mWaterLevels;
+    std::vector<char> mMoved;
 
     float mRippleLifeTime;
     float mRippleRotSpeed;
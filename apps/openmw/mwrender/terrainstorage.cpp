@@ -51,6 +51,11 @@ namespace MWRender
     }
 
     ESM::Land* TerrainStorage::getLand(int cellX, int cellY)
+    {
+        return getLoadedLand(cellX, cellY);
+    }
+
+    ESM::Land* TerrainStorage::getLoadedLand(int cellX, int cellY)
     {
         const MWWorld::ESMStore &esmStore =
             MWBase::Environment::get().getWorld()->getStore();
@@ -58,9 +63,8 @@ namespace MWRender
         if (!land)
             return NULL;
 
-        const int flags = ESM::Land::DATA_VCLR|ESM::Land::DATA_VHGT|ESM::Land::DATA_VNML|ESM::Land::DATA_VTEX;
-        if (!land->isDataLoaded(flags))
-            land->loadData(flags);
+        // Land::loadData is serialised per land, so different lands are decoded concurrently
+        land->loadData(ESM::Land::DATA_VCLR|ESM::Land::DATA_VHGT|ESM::Land::DATA_VNML|ESM::Land::DATA_VTEX);
         return land;
     }
 
@@ -20,6 +20,9 @@ namespace MWRender
 
         /// Get bounds of the whole terrain in cell units
         virtual void getBounds(float& minX, float& maxX, float& minY, float& maxY);
+
+        /// Search the land of a cell and load the data used for rendering and physics. Thread safe.
+        static ESM::Land* getLoadedLand(int cellX, int cellY);
     };
 
 }
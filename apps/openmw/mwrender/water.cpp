@@ -496,11 +496,6 @@ void Water::removeEmitter (const MWWorld::Ptr& ptr)
     mSimulation->removeEmitter (ptr);
 }
 
-void Water::updateEmitterPtr (const MWWorld::Ptr& old, const MWWorld::Ptr& ptr)
-{
-    mSimulation->updateEmitterPtr(old, ptr);
-}
-
 void Water::clearRipples()
 {
     mSimulation->clear();
@@ -70,45 +70,65 @@ namespace MWScript
         }
     }
 
-    const Locals& InterpreterContext::getMemberLocals (std::string& id, bool global)
-        const
+    MemberCache::Entry& InterpreterContext::getMemberEntry (const std::string& id,
+        const std::string& name, bool global) const
+    {
+        return MWBase::Environment::get().getScriptManager()->getMemberCache().get (id, name, global);
+    }
+
+    Locals& InterpreterContext::getMemberLocals (MemberCache::Entry& entry, const std::string& id,
+        bool global) const
     {
         if (global)
         {
+            if (entry.mScriptId.empty())
+                entry.mScriptId = id;
+
             return MWBase::Environment::get().getScriptManager()->getGlobalScripts().
                 getLocals (id);
         }
-        else
-        {
-            const MWWorld::Ptr ptr = getReferenceImp (id, false);
 
-             id = ptr.getClass().getScript (ptr);
+        MWBase::World *world = MWBase::Environment::get().getWorld();
+
+        unsigned int generation = world->getReferenceGeneration();
+
+        if (!entry.mPtr.isEmpty() && entry.mGeneration==generation)
+            return entry.mPtr.getRefData().getLocals();
+
+        const MWWorld::Ptr ptr = getReferenceImp (id, false);
 
-            ptr.getRefData().setLocals (
-                *MWBase::Environment::get().getWorld()->getStore().get<ESM::Script>().find (id));
+        std::string scriptId = ptr.getClass().getScript (ptr);
 
-            return ptr.getRefData().getLocals();
+        if (scriptId!=entry.mScriptId)
+        {
+            entry.mScriptId = scriptId;
+            entry.resetIndices();
         }
-    }
 
-    Locals& InterpreterContext::getMemberLocals (std::string& id, bool global)
-    {
-        if (global)
+        ptr.getRefData().setLocals (
+            *world->getStore().get<ESM::Script>().find (scriptId));
+
+        // references in containers can be restacked or removed without the generation changing
+        if (ptr.isInCell())
         {
-            return MWBase::Environment::get().getScriptManager()->getGlobalScripts().
-                getLocals (id);
+            entry.mPtr = ptr;
+            entry.mGeneration = generation;
         }
         else
-        {
-            const MWWorld::Ptr ptr = getReferenceImp (id, false);
+            entry.mPtr = MWWorld::Ptr();
 
-            id = ptr.getClass().getScript (ptr);
+        return ptr.getRefData().getLocals();
+    }
 
-            ptr.getRefData().setLocals (
-                *MWBase::Environment::get().getWorld()->getStore().get<ESM::Script>().find (id));
+    int InterpreterContext::getMemberIndex (MemberCache::Entry& entry, const std::string& name,
+        char type) const
+    {
+        int& index = entry.getIndex (type);
 
-            return ptr.getRefData().getLocals();
-        }
+        if (index==-1)
+            index = findLocalVariableIndex (entry.mScriptId, name, type);
+
+        return index;
     }
 
     int InterpreterContext::findLocalVariableIndex (const std::string& scriptId,
@@ -140,7 +160,8 @@ namespace MWScript
     InterpreterContext::InterpreterContext (
         MWScript::Locals *locals, MWWorld::Ptr reference, const std::string& targetId)
     : mLocals (locals), mReference (reference),
-      mActivationHandled (false), mTargetId (targetId)
+      mActivationHandled (false), mTargetId (targetId),
+      mSecondsPassed (MWBase::Environment::get().getFrameDuration())
     {
         // If we run on a reference (local script, dialogue script or console with object
         // selected), store the ID of that reference store it so it can be inherited by
@@ -513,7 +534,12 @@ namespace MWScript
 
     float InterpreterContext::getSecondsPassed() const
     {
-        return MWBase::Environment::get().getFrameDuration();
+        return mSecondsPassed;
+    }
+
+    void InterpreterContext::setSecondsPassed (float seconds)
+    {
+        mSecondsPassed = seconds;
     }
 
     bool InterpreterContext::isDisabled (const std::string& id) const
@@ -537,59 +563,61 @@ namespace MWScript
     int InterpreterContext::getMemberShort (const std::string& id, const std::string& name,
         bool global) const
     {
-        std::string scriptId (id);
+        MemberCache::Entry& entry = getMemberEntry (id, name, global);
 
-        const Locals& locals = getMemberLocals (scriptId, global);
+        const Locals& locals = getMemberLocals (entry, id, global);
 
-        return locals.mShorts[findLocalVariableIndex (scriptId, name, 's')];
+        return locals.mShorts[getMemberIndex (entry, name, 's')];
     }
 
     int InterpreterContext::getMemberLong (const std::string& id, const std::string& name,
         bool global) const
     {
-        std::string scriptId (id);
+        MemberCache::Entry& entry = getMemberEntry (id, name, global);
 
-        const Locals& locals = getMemberLocals (scriptId, global);
+        const Locals& locals = getMemberLocals (entry, id, global);
 
-        return locals.mLongs[findLocalVariableIndex (scriptId, name, 'l')];
+        return locals.mLongs[getMemberIndex (entry, name, 'l')];
     }
 
     float InterpreterContext::getMemberFloat (const std::string& id, const std::string& name,
         bool global) const
     {
-        std::string scriptId (id);
+        MemberCache::Entry& entry = getMemberEntry (id, name, global);
 
-        const Locals& locals = getMemberLocals (scriptId, global);
+        const Locals& locals = getMemberLocals (entry, id, global);
 
-        return locals.mFloats[findLocalVariableIndex (scriptId, name, 'f')];
+        return locals.mFloats[getMemberIndex (entry, name, 'f')];
     }
 
     void InterpreterContext::setMemberShort (const std::string& id, const std::string& name,
         int value, bool global)
     {
-        std::string scriptId (id);
+        MemberCache::Entry& entry = getMemberEntry (id, name, global);
 
-        Locals& locals = getMemberLocals (scriptId, global);
+        Locals& locals = getMemberLocals (entry, id, global);
 
-        locals.mShorts[findLocalVariableIndex (scriptId, name, 's')] = value;
+        locals.mShorts[getMemberIndex (entry, name, 's')] = value;
     }
 
-    void InterpreterContext::setMemberLong (const std::string& id, const std::string& name, int value, bool global)
+    void InterpreterContext::setMemberLong (const std::string& id, const std::string& name,
+        int value, bool global)
     {
-        std::string scriptId (id);
+        MemberCache::Entry& entry = getMemberEntry (id, name, global);
 
-        Locals& locals = getMemberLocals (scriptId, global);
+        Locals& locals = getMemberLocals (entry, id, global);
 
-        locals.mLongs[findLocalVariableIndex (scriptId, name, 'l')] = value;
+        locals.mLongs[getMemberIndex (entry, name, 'l')] = value;
     }
 
-    void InterpreterContext::setMemberFloat (const std::string& id, const std::string& name, float value, bool global)
+    void InterpreterContext::setMemberFloat (const std::string& id, const std::string& name,
+        float value, bool global)
     {
-        std::string scriptId (id);
+        MemberCache::Entry& entry = getMemberEntry (id, name, global);
 
-        Locals& locals = getMemberLocals (scriptId, global);
+        Locals& locals = getMemberLocals (entry, id, global);
 
-        locals.mFloats[findLocalVariableIndex (scriptId, name, 'f')] = value;
+        locals.mFloats[getMemberIndex (entry, name, 'f')] = value;
     }
 
     MWWorld::Ptr InterpreterContext::getReference(bool required)
@@ -8,6 +8,8 @@
 #include "../mwworld/ptr.hpp"
 #include "../mwworld/action.hpp"
 
+#include "membercache.hpp"
+
 namespace MWSound
 {
     class SoundManager;
@@ -32,6 +34,8 @@ namespace MWScript
 
             std::string mTargetId;
 
+            float mSecondsPassed;
+
             /// If \a id is empty, a reference the script is run from is returned or in case
             /// of a non-local script the reference derived from the target ID.
             MWWorld::Ptr getReferenceImp (const std::string& id = "", bool activeOnly = false,
@@ -42,11 +46,16 @@ namespace MWScript
             const MWWorld::Ptr getReferenceImp (const std::string& id = "",
                 bool activeOnly = false, bool doThrow=true) const;
 
-            const Locals& getMemberLocals (std::string& id, bool global) const;
-            ///< \a id is changed to the respective script ID, if \a id wasn't a script ID before
+            MemberCache::Entry& getMemberEntry (const std::string& id, const std::string& name,
+                bool global) const;
 
-            Locals& getMemberLocals (std::string& id, bool global);
-            ///< \a id is changed to the respective script ID, if \a id wasn't a script ID before
+            Locals& getMemberLocals (MemberCache::Entry& entry, const std::string& id,
+                bool global) const;
+            ///< Resolve the locals of \a id and store the script ID and (if it is safe to reuse)
+            /// the reference in \a entry.
+
+            int getMemberIndex (MemberCache::Entry& entry, const std::string& name, char type) const;
+            ///< Throws an exception if local variable can't be found.
 
             /// Throws an exception if local variable can't be found.
             int findLocalVariableIndex (const std::string& scriptId, const std::string& name,
@@ -146,6 +155,10 @@ namespace MWScript
 
             virtual float getSecondsPassed() const;
 
+            void setSecondsPassed (float seconds);
+            ///< Override the time returned by getSecondsPassed (default: duration of the current
+            /// frame), for scripts that did not run in every frame.
+
             virtual bool isDisabled (const std::string& id = "") const;
 
             virtual void enable (const std::string& id = "");
@@ -0,0 +1,42 @@
+#include "membercache.hpp"
+
+#include <stdexcept>
+
+namespace MWScript
+{
+    MemberCache::Entry::Entry()
+    : mGeneration (0), mShort (-1), mLong (-1), mFloat (-1)
+    {}
+
+    int& MemberCache::Entry::getIndex (char type)
+    {
+        switch (type)
+        {
+            case 's': return mShort;
+            case 'l': return mLong;
+            case 'f': return mFloat;
+        }
+
+        throw std::logic_error (std::string ("unknown local variable type ") + type);
+    }
+
+    void MemberCache::Entry::resetIndices()
+    {
+        mShort = mLong = mFloat = -1;
+    }
+
+    MemberCache::Entry& MemberCache::get (const std::string& id, const std::string& variable,
+        bool global)
+    {
+        Container& container = global ? mGlobal : mLocal;
+
+        std::pair<std::string, std::string> key (id, variable);
+
+        Container::iterator iter = container.find (key);
+
+        if (iter==container.end())
+            iter = container.insert (std::make_pair (key, Entry())).first;
+
+        return iter->second;
+    }
+}
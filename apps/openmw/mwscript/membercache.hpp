@@ -0,0 +1,51 @@
+#ifndef GAME_SCRIPT_MEMBERCACHE_H
+#define GAME_SCRIPT_MEMBERCACHE_H
+
+#include <string>
+#include <map>
+
+#include "../mwworld/ptr.hpp"
+
+namespace MWScript
+{
+    /// \brief Resolved targets of member variable accesses ("ref".var) from scripts
+    ///
+    /// Entries are keyed by the (id, variable) literal pair of the access, which is identical
+    /// for every call site using it. The reference is only reused while the world's reference
+    /// generation is unchanged.
+    class MemberCache
+    {
+        public:
+
+            struct Entry
+            {
+                unsigned int mGeneration;
+                MWWorld::Ptr mPtr; ///< empty for global scripts or if not resolved yet
+                std::string mScriptId;
+                int mShort; ///< -1: not resolved yet
+                int mLong; ///< -1: not resolved yet
+                int mFloat; ///< -1: not resolved yet
+
+                Entry();
+
+                int& getIndex (char type);
+
+                void resetIndices();
+            };
+
+        private:
+
+            typedef std::map<std::pair<std::string, std::string>, Entry> Container;
+
+            Container mLocal;
+            Container mGlobal;
+
+        public:
+
+            Entry& get (const std::string& id, const std::string& variable, bool global);
+            ///< Return entry for the given access (a new unresolved entry is created, if
+            /// there is none yet).
+    };
+}
+
+#endif
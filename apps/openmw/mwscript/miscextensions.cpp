@@ -2,6 +2,7 @@
 #include "miscextensions.hpp"
 
 #include <cstdlib>
+#include <sstream>
 
 #include <components/compiler/extensions.hpp>
 #include <components/compiler/opcodes.hpp>
@@ -31,6 +32,7 @@
 
 #include "interpretercontext.hpp"
 #include "ref.hpp"
+#include "scriptprofiler.hpp"
 
 namespace
 {
@@ -909,6 +911,27 @@ namespace MWScript
             }
         };
 
+        class OpToggleScriptProfiler : public Interpreter::Opcode0
+        {
+        public:
+            virtual void execute (Interpreter::Runtime& runtime)
+            {
+                MWScript::ScriptProfiler& profiler =
+                    MWBase::Environment::get().getScriptManager()->getProfiler();
+
+                bool enabled = profiler.toggle();
+
+                runtime.getContext().report(enabled ? "Script Profiler -> On" : "Script Profiler -> Off");
+
+                if (!enabled)
+                {
+                    std::ostringstream stream;
+                    profiler.report (stream, 10);
+                    runtime.getContext().report (stream.str());
+                }
+            }
+        };
+
         class OpToggleGodMode : public Interpreter::Opcode0
         {
             public:
@@ -1213,6 +1236,7 @@ namespace MWScript
             interpreter.installSegment5 (Compiler::Misc::opcodeShowVarsExplicit, new OpShowVars<ExplicitRef>);
             interpreter.installSegment5 (Compiler::Misc::opcodeToggleGodMode, new OpToggleGodMode);
             interpreter.installSegment5 (Compiler::Misc::opcodeToggleScripts, new OpToggleScripts);
+            interpreter.installSegment5 (Compiler::Misc::opcodeToggleScriptProfiler, new OpToggleScriptProfiler);
             interpreter.installSegment5 (Compiler::Misc::opcodeDisableLevitation, new OpEnableLevitation<false>);
             interpreter.installSegment5 (Compiler::Misc::opcodeEnableLevitation, new OpEnableLevitation<true>);
             interpreter.installSegment5 (Compiler::Misc::opcodeCast, new OpCast<ImplicitRef>);
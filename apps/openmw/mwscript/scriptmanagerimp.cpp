@@ -7,6 +7,8 @@
 #include <exception>
 #include <algorithm>
 
+#include <OgreTimer.h>
+
 #include <components/esm/loadscpt.hpp>
 
 #include <components/misc/stringops.hpp>
@@ -15,13 +17,72 @@
 #include <components/compiler/context.hpp>
 #include <components/compiler/exception.hpp>
 #include <components/compiler/quickfileparser.hpp>
+#include <components/compiler/generator.hpp>
+#include <components/compiler/opcodes.hpp>
 
 #include "../mwworld/esmstore.hpp"
+#include "../mwworld/cellref.hpp"
 
 #include "extensions.hpp"
+#include "interpretercontext.hpp"
+
+namespace
+{
+    // Segment 5 opcodes emitted by Compiler::Generator (see opFetchIntLiteral, opEqualInt and
+    // opSkipOnNonZero in components/compiler/generator.cpp and the matching installSegment5 calls in
+    // components/interpreter/installopcodes.cpp). Keep in sync.
+    const int opcodeFetchIntLiteral = 4;
+    const int opcodeSkipOnNonZero = 25;
+    const int opcodeEqualInt = 26;
+
+    /// Does \a code consist of a single "if ( OnActivate )" or "if ( OnActivate == 1 )" block
+    /// (i.e. it does nothing, unless the script is run on activation)?
+    bool isActivationOnly (const std::vector<Interpreter::Type_Code>& code)
+    {
+        using namespace Compiler::Generator;
+
+        if (code.size()<4)
+            return false;
+
+        const int opcodes = static_cast<int> (code[0]);
+        const Interpreter::Type_Code *block = &code[4];
+        int pc = 0;
+
+        if (opcodes<3 || block[pc++]!=segment5 (Compiler::Misc::opcodeOnActivate))
+            return false;
+
+        if (opcodes>=6 && (block[pc] & 0xff000000)==segment0 (0, 0))
+        {
+            // == 1 (pushInt + fetchIntLiteral + equalInt)
+            int index = block[pc] & 0xffffff;
+
+            if (index>=static_cast<int> (code[1]) || code[4+opcodes+index]!=1 ||
+                block[pc+1]!=segment5 (opcodeFetchIntLiteral) ||
+                block[pc+2]!=segment5 (opcodeEqualInt))
+                return false;
+
+            pc += 3;
+        }
+
+        // skipOnNonZero + jumpForward to end of script
+        if (pc+2>opcodes || block[pc]!=segment5 (opcodeSkipOnNonZero) ||
+            (block[pc+1] & 0xff000000)!=segment0 (1, 0))
+            return false;
+
+        int offset = block[pc+1] & 0xffffff;
+
+        return pc+1+offset==opcodes;
+    }
+}
 
 namespace MWScript
 {
+    ScriptManager::CompiledScript::CompiledScript (
+        const std::vector<Interpreter::Type_Code>& byteCode, const Compiler::Locals& locals)
+    : mByteCode (byteCode), mLocals (locals), mActivationOnly (::isActivationOnly (byteCode)),
+      mHandle (-1)
+    {}
+
     ScriptManager::ScriptManager (const MWWorld::ESMStore& store, bool verbose,
         Compiler::Context& compilerContext, int warningsMode,
         const std::vector<std::string>& scriptBlacklist)
@@ -51,9 +112,10 @@ namespace MWScript
             bool Success = true;
             try
             {
-                std::istringstream input (script->mScriptText);
+                const std::string& source = script->mScriptText;
 
-                Compiler::Scanner scanner (mErrorHandler, input, mCompilerContext.getExtensions());
+                Compiler::Scanner scanner (mErrorHandler, source.data(),
+                    source.data()+source.size(), mCompilerContext.getExtensions());
 
                 scanner.scan (mParser);
 
@@ -83,7 +145,7 @@ namespace MWScript
             {
                 std::vector<Interpreter::Type_Code> code;
                 mParser.getCode (code);
-                mScripts.insert (std::make_pair (name, std::make_pair (code, mParser.getLocals())));
+                mScripts.insert (std::make_pair (name, CompiledScript (code, mParser.getLocals())));
 
                 return true;
             }
@@ -92,9 +154,8 @@ namespace MWScript
         return false;
     }
 
-    void ScriptManager::run (const std::string& name, Interpreter::Context& interpreterContext)
+    ScriptManager::ScriptCollection::iterator ScriptManager::getCompiled (const std::string& name)
     {
-        // compile script
         ScriptCollection::iterator iter = mScripts.find (name);
 
         if (iter==mScripts.end())
@@ -103,16 +164,22 @@ namespace MWScript
             {
                 // failed -> ignore script from now on.
                 std::vector<Interpreter::Type_Code> empty;
-                mScripts.insert (std::make_pair (name, std::make_pair (empty, Compiler::Locals())));
-                return;
+                return mScripts.insert (std::make_pair (name, CompiledScript (empty, Compiler::Locals()))).first;
             }
 
             iter = mScripts.find (name);
             assert (iter!=mScripts.end());
         }
 
-        // execute script
-        if (!iter->second.first.empty())
+        return iter;
+    }
+
+    void ScriptManager::execute (ScriptCollection::iterator iter,
+        Interpreter::Context& interpreterContext)
+    {
+        std::vector<Interpreter::Type_Code>& byteCode = iter->second.mByteCode;
+
+        if (!byteCode.empty())
             try
             {
                 if (!mOpcodesInstalled)
@@ -121,17 +188,98 @@ namespace MWScript
                     mOpcodesInstalled = true;
                 }
 
-                mInterpreter.run (&iter->second.first[0], iter->second.first.size(), interpreterContext);
+                if (mProfiler.isEnabled())
+                    runProfiled (iter->first, &byteCode[0], byteCode.size(), interpreterContext);
+                else
+                    mInterpreter.run (&byteCode[0], byteCode.size(), interpreterContext);
             }
             catch (const std::exception& e)
             {
-                std::cerr << "Execution of script " << name << " failed:" << std::endl;
+                std::cerr << "Execution of script " << iter->first << " failed:" << std::endl;
                 std::cerr << e.what() << std::endl;
 
-                iter->second.first.clear(); // don't execute again.
+                byteCode.clear(); // don't execute again.
             }
     }
 
+    void ScriptManager::run (const std::string& name, Interpreter::Context& interpreterContext)
+    {
+        execute (getCompiled (name), interpreterContext);
+    }
+
+    int ScriptManager::getHandle (const std::string& name)
+    {
+        ScriptCollection::iterator iter = getCompiled (name);
+
+        if (iter->second.mHandle==-1)
+        {
+            iter->second.mHandle = static_cast<int> (mHandles.size());
+            mHandles.push_back (iter);
+        }
+
+        return iter->second.mHandle;
+    }
+
+    void ScriptManager::run (int handle, Interpreter::Context& interpreterContext)
+    {
+        execute (mHandles.at (handle), interpreterContext);
+    }
+
+    bool ScriptManager::isActivationOnly (int handle) const
+    {
+        return mHandles.at (handle)->second.mActivationOnly;
+    }
+
+    void ScriptManager::runProfiled (const std::string& name, const Interpreter::Type_Code *code,
+        int codeSize, Interpreter::Context& interpreterContext)
+    {
+        ScriptProfiler::ScriptProfile& profile = mProfiler.getScriptProfile (name);
+
+        unsigned int instructions = profile.mStatistics.mInstructions;
+
+        mInterpreter.setStatistics (&profile.mStatistics);
+
+        Ogre::Timer timer;
+
+        try
+        {
+            mInterpreter.run (code, codeSize, interpreterContext);
+        }
+        catch (...)
+        {
+            mInterpreter.setStatistics (0);
+            throw;
+        }
+
+        unsigned long microseconds = timer.getMicroseconds();
+
+        mInterpreter.setStatistics (0);
+
+        std::string reference = interpreterContext.getTargetId();
+
+        if (InterpreterContext *context = dynamic_cast<InterpreterContext *> (&interpreterContext))
+        {
+            MWWorld::Ptr ptr = context->getReference (false);
+
+            if (!ptr.isEmpty())
+            {
+                std::ostringstream stream;
+
+                stream << ptr.getCellRef().getRefId();
+
+                const ESM::RefNum& refNum = ptr.getCellRef().getRefNum();
+
+                if (refNum.hasContentFile())
+                    stream << " [" << refNum.mContentFile << ":" << refNum.mIndex << "]";
+
+                reference = stream.str();
+            }
+        }
+
+        mProfiler.addRun (profile, name, reference, microseconds,
+            profile.mStatistics.mInstructions-instructions);
+    }
+
     std::pair<int, int> ScriptManager::compileAll()
     {
         int count = 0;
@@ -161,7 +309,7 @@ namespace MWScript
             ScriptCollection::iterator iter = mScripts.find (name2);
 
             if (iter!=mScripts.end())
-                return iter->second.second;
+                return iter->second.mLocals;
         }
 
         {
@@ -180,9 +328,10 @@ namespace MWScript
 
             Compiler::Locals locals;
 
-            std::istringstream stream (script->mScriptText);
+            const std::string& source = script->mScriptText;
             Compiler::QuickFileParser parser (mErrorHandler, mCompilerContext, locals);
-            Compiler::Scanner scanner (mErrorHandler, stream, mCompilerContext.getExtensions());
+            Compiler::Scanner scanner (mErrorHandler, source.data(), source.data()+source.size(),
+                mCompilerContext.getExtensions());
             scanner.scan (parser);
 
             std::map<std::string, Compiler::Locals>::iterator iter =
@@ -198,4 +347,14 @@ namespace MWScript
     {
         return mGlobalScripts;
     }
+
+    MemberCache& ScriptManager::getMemberCache()
+    {
+        return mMemberCache;
+    }
+
+    ScriptProfiler& ScriptManager::getProfiler()
+    {
+        return mProfiler;
+    }
 }
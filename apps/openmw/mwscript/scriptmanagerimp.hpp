@@ -13,6 +13,8 @@
 #include "../mwbase/scriptmanager.hpp"
 
 #include "globalscripts.hpp"
+#include "membercache.hpp"
+#include "scriptprofiler.hpp"
 
 namespace MWWorld
 {
@@ -42,14 +44,36 @@ namespace MWScript
             Interpreter::Interpreter mInterpreter;
             bool mOpcodesInstalled;
 
-            typedef std::pair<std::vector<Interpreter::Type_Code>, Compiler::Locals> CompiledScript;
+            struct CompiledScript
+            {
+                std::vector<Interpreter::Type_Code> mByteCode;
+                Compiler::Locals mLocals;
+                bool mActivationOnly;
+                int mHandle; ///< -1: no handle requested yet
+
+                CompiledScript (const std::vector<Interpreter::Type_Code>& byteCode,
+                    const Compiler::Locals& locals);
+            };
+
             typedef std::map<std::string, CompiledScript> ScriptCollection;
 
             ScriptCollection mScripts;
+            std::vector<ScriptCollection::iterator> mHandles;
             GlobalScripts mGlobalScripts;
+            MemberCache mMemberCache;
+            ScriptProfiler mProfiler;
             std::map<std::string, Compiler::Locals> mOtherLocals;
             std::vector<std::string> mScriptBlacklist;
 
+            ScriptCollection::iterator getCompiled (const std::string& name);
+            ///< Compile script, if not compiled yet. Scripts that fail to compile are stored
+            /// without code.
+
+            void execute (ScriptCollection::iterator iter, Interpreter::Context& interpreterContext);
+
+            void runProfiled (const std::string& name, const Interpreter::Type_Code *code,
+                int codeSize, Interpreter::Context& interpreterContext);
+
         public:
 
             ScriptManager (const MWWorld::ESMStore& store, bool verbose,
@@ -59,6 +83,16 @@ namespace MWScript
             virtual void run (const std::string& name, Interpreter::Context& interpreterContext);
             ///< Run the script with the given name (compile first, if not compiled yet)
 
+            virtual int getHandle (const std::string& name);
+            ///< Return a handle that can be used to run the script with the given name without
+            /// looking it up again (compile first, if not compiled yet).
+
+            virtual void run (int handle, Interpreter::Context& interpreterContext);
+            ///< Run the script with the given handle.
+
+            virtual bool isActivationOnly (int handle) const;
+            ///< Can the script only have an effect, when it is run on activation of its reference?
+
             virtual bool compile (const std::string& name);
             ///< Compile script with the given namen
             /// \return Success?
@@ -71,6 +105,11 @@ namespace MWScript
             ///< Return locals for script \a name.
 
             virtual GlobalScripts& getGlobalScripts();
+
+            virtual MemberCache& getMemberCache();
+            ///< Return resolved targets of member variable accesses.
+
+            virtual ScriptProfiler& getProfiler();
     };
 }
 
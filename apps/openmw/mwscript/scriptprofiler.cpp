@@ -0,0 +1,155 @@
+#include "scriptprofiler.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+
+namespace
+{
+    typedef std::pair<unsigned long long, std::string> TimeAndName;
+
+    /// Sort descending by time
+    bool compareTime (const TimeAndName& left, const TimeAndName& right)
+    {
+        return left.first>right.first;
+    }
+
+    template<typename T>
+    void sortByTime (const std::map<std::string, T>& profiles, std::vector<TimeAndName>& sorted)
+    {
+        for (typename std::map<std::string, T>::const_iterator iter (profiles.begin());
+            iter!=profiles.end(); ++iter)
+            sorted.push_back (std::make_pair (iter->second.mMicroseconds, iter->first));
+
+        std::sort (sorted.begin(), sorted.end(), compareTime);
+    }
+
+    void writeTime (std::ostream& stream, unsigned long long microseconds, unsigned int runs)
+    {
+        stream
+            << std::fixed << std::setprecision (3) << microseconds/1000.0 << " ms total, "
+            << (runs ? static_cast<double> (microseconds)/runs : 0.0) << " us/run, "
+            << runs << " runs";
+    }
+}
+
+namespace MWScript
+{
+    ScriptProfiler::ScriptProfile::ScriptProfile() : mRuns (0), mMicroseconds (0) {}
+
+    ScriptProfiler::ReferenceProfile::ReferenceProfile()
+    : mRuns (0), mMicroseconds (0), mInstructions (0)
+    {}
+
+    ScriptProfiler::ScriptProfiler() : mEnabled (false) {}
+
+    bool ScriptProfiler::isEnabled() const
+    {
+        return mEnabled;
+    }
+
+    bool ScriptProfiler::toggle()
+    {
+        mEnabled = !mEnabled;
+        return mEnabled;
+    }
+
+    void ScriptProfiler::setEnabled (bool enabled)
+    {
+        mEnabled = enabled;
+    }
+
+    bool ScriptProfiler::isEmpty() const
+    {
+        return mScripts.empty();
+    }
+
+    void ScriptProfiler::clear()
+    {
+        mScripts.clear();
+        mReferences.clear();
+    }
+
+    ScriptProfiler::ScriptProfile& ScriptProfiler::getScriptProfile (const std::string& script)
+    {
+        return mScripts[script];
+    }
+
+    void ScriptProfiler::addRun (ScriptProfile& profile, const std::string& script,
+        const std::string& reference, unsigned long long microseconds, unsigned int instructions)
+    {
+        ++profile.mRuns;
+        profile.mMicroseconds += microseconds;
+
+        if (!reference.empty())
+        {
+            ReferenceProfile& refProfile = mReferences[reference];
+
+            refProfile.mScript = script;
+            ++refProfile.mRuns;
+            refProfile.mMicroseconds += microseconds;
+            refProfile.mInstructions += instructions;
+        }
+    }
+
+    void ScriptProfiler::report (std::ostream& stream, std::size_t limit) const
+    {
+        std::vector<TimeAndName> scripts;
+        sortByTime (mScripts, scripts);
+
+        if (scripts.size()>limit)
+            scripts.resize (limit);
+
+        for (std::vector<TimeAndName>::const_iterator iter (scripts.begin());
+            iter!=scripts.end(); ++iter)
+        {
+            const ScriptProfile& profile = mScripts.find (iter->second)->second;
+
+            stream << iter->second << ": ";
+            writeTime (stream, profile.mMicroseconds, profile.mRuns);
+            stream << std::endl;
+        }
+    }
+
+    void ScriptProfiler::write (std::ostream& stream) const
+    {
+        stream << "scripts (sorted by total time):" << std::endl;
+
+        std::vector<TimeAndName> sorted;
+        sortByTime (mScripts, sorted);
+
+        for (std::vector<TimeAndName>::const_iterator iter (sorted.begin());
+            iter!=sorted.end(); ++iter)
+        {
+            const ScriptProfile& profile = mScripts.find (iter->second)->second;
+
+            stream << "  " << iter->second << ": ";
+            writeTime (stream, profile.mMicroseconds, profile.mRuns);
+            stream << ", " << profile.mStatistics.mInstructions << " instructions" << std::endl;
+
+            for (std::map<std::pair<int, int>, unsigned int>::const_iterator opcode
+                (profile.mStatistics.mOpcodes.begin());
+                opcode!=profile.mStatistics.mOpcodes.end(); ++opcode)
+                stream
+                    << "    segment " << opcode->first.first
+                    << " opcode 0x" << std::hex << opcode->first.second << std::dec
+                    << ": " << opcode->second << std::endl;
+        }
+
+        stream << std::endl << "references (sorted by total time):" << std::endl;
+
+        sorted.clear();
+        sortByTime (mReferences, sorted);
+
+        for (std::vector<TimeAndName>::const_iterator iter (sorted.begin());
+            iter!=sorted.end(); ++iter)
+        {
+            const ReferenceProfile& profile = mReferences.find (iter->second)->second;
+
+            stream << "  " << iter->second << " (" << profile.mScript << "): ";
+            writeTime (stream, profile.mMicroseconds, profile.mRuns);
+            stream << ", " << profile.mInstructions << " instructions" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef GAME_SCRIPT_SCRIPTPROFILER_H
+#define GAME_SCRIPT_SCRIPTPROFILER_H
+
+#include <map>
+#include <string>
+#include <iosfwd>
+
+#include <components/interpreter/interpreter.hpp>
+
+namespace MWScript
+{
+    /// \brief Opt-in collection of execution times and instruction counts of scripts
+    class ScriptProfiler
+    {
+        public:
+
+            struct ScriptProfile
+            {
+                unsigned int mRuns;
+                unsigned long long mMicroseconds;
+                Interpreter::Statistics mStatistics;
+
+                ScriptProfile();
+            };
+
+            struct ReferenceProfile
+            {
+                std::string mScript;
+                unsigned int mRuns;
+                unsigned long long mMicroseconds;
+                unsigned int mInstructions;
+
+                ReferenceProfile();
+            };
+
+        private:
+
+            bool mEnabled;
+            std::map<std::string, ScriptProfile> mScripts;
+            std::map<std::string, ReferenceProfile> mReferences;
+
+        public:
+
+            ScriptProfiler();
+
+            bool isEnabled() const;
+
+            bool toggle();
+            ///< \return Resulting mode
+
+            void setEnabled (bool enabled);
+
+            bool isEmpty() const;
+            ///< Has nothing been recorded yet?
+
+            void clear();
+
+            ScriptProfile& getScriptProfile (const std::string& script);
+            ///< The statistics of the returned profile are meant to be handed to the
+            /// interpreter while the script is running.
+
+            void addRun (ScriptProfile& profile, const std::string& script,
+                const std::string& reference, unsigned long long microseconds,
+                unsigned int instructions);
+            ///< \param reference Description of the reference the script ran on (empty for
+            /// global scripts that are not targeted).
+
+            void report (std::ostream& stream, std::size_t limit) const;
+            ///< Write summary of the \a limit scripts with the highest total time.
+
+            void write (std::ostream& stream) const;
+            ///< Write all data, including opcode histograms.
+    };
+}
+
+#endif
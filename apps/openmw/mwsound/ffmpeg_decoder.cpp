@@ -297,6 +297,11 @@ std::string FFmpeg_Decoder::getName()
     return mFormatCtx->filename;
 }
 
+size_t FFmpeg_Decoder::getFileSize()
+{
+    return mDataStream->size();
+}
+
 void FFmpeg_Decoder::getInfo(int *samplerate, ChannelConfig *chans, SampleType *type)
 {
     if(!mStream)
@@ -78,6 +78,7 @@ namespace MWSound
         virtual void close();
 
         virtual std::string getName();
+        virtual size_t getFileSize();
         virtual void getInfo(int *samplerate, ChannelConfig *chans, SampleType *type);
 
         virtual size_t read(char *buffer, size_t bytes);
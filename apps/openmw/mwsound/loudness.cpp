@@ -1,5 +1,11 @@
 #include "loudness.hpp"
 
+#include <cstring>
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
 #include "soundmanagerimp.hpp"
 
 namespace MWSound
@@ -51,3 +57,144 @@ namespace MWSound
     }
 
 }
+
+namespace
+{
+    const char *loudnessCacheMagic = "OMWLOUD2";
+}
+
+namespace MWSound
+{
+
+    LoudnessCache::LoudnessCache()
+    : mValuesPerSecond (0), mChanged (false)
+    {}
+
+    void LoudnessCache::load (const std::string& path, float valuesPerSecond)
+    {
+        boost::mutex::scoped_lock lock (mMutex);
+
+        mEntries.clear();
+        mPath = path;
+        mValuesPerSecond = valuesPerSecond;
+        mChanged = false;
+
+        boost::filesystem::ifstream stream (boost::filesystem::path (path), std::ios::binary);
+
+        if (!stream.is_open())
+            return;
+
+        char magic[8];
+        float storedValuesPerSecond = 0;
+        Ogre::uint32 count = 0;
+
+        stream.read (magic, sizeof (magic));
+        stream.read (reinterpret_cast<char *> (&storedValuesPerSecond), sizeof (storedValuesPerSecond));
+        stream.read (reinterpret_cast<char *> (&count), sizeof (count));
+
+        if (!stream.good() || std::memcmp (magic, loudnessCacheMagic, sizeof (magic))!=0 ||
+            storedValuesPerSecond!=valuesPerSecond)
+            return;
+
+        for (Ogre::uint32 i=0; i<count; ++i)
+        {
+            Ogre::uint32 nameSize = 0;
+            Ogre::uint64 size = 0;
+            Ogre::uint32 valueCount = 0;
+
+            stream.read (reinterpret_cast<char *> (&nameSize), sizeof (nameSize));
+
+            if (!stream.good())
+                break;
+
+            std::string name (nameSize, '\0');
+
+            if (nameSize>0)
+                stream.read (&name[0], nameSize);
+
+            stream.read (reinterpret_cast<char *> (&size), sizeof (size));
+            stream.read (reinterpret_cast<char *> (&valueCount), sizeof (valueCount));
+
+            if (!stream.good())
+                break;
+
+            std::vector<float> values (valueCount);
+
+            if (valueCount>0)
+                stream.read (reinterpret_cast<char *> (&values[0]), valueCount*sizeof (float));
+
+            if (!stream.good())
+                break;
+
+            mEntries[Key (name, static_cast<std::size_t> (size))].swap (values);
+        }
+    }
+
+    void LoudnessCache::save()
+    {
+        boost::mutex::scoped_lock lock (mMutex);
+
+        if (!mChanged || mPath.empty())
+            return;
+
+        boost::filesystem::path path (mPath);
+
+        boost::system::error_code error;
+        boost::filesystem::create_directories (path.parent_path(), error);
+
+        boost::filesystem::ofstream stream (path, std::ios::binary | std::ios::trunc);
+
+        Ogre::uint32 count = static_cast<Ogre::uint32> (mEntries.size());
+
+        stream.write (loudnessCacheMagic, 8);
+        stream.write (reinterpret_cast<const char *> (&mValuesPerSecond), sizeof (mValuesPerSecond));
+        stream.write (reinterpret_cast<const char *> (&count), sizeof (count));
+
+        for (EntryMap::const_iterator iter (mEntries.begin()); iter!=mEntries.end(); ++iter)
+        {
+            Ogre::uint32 nameSize = static_cast<Ogre::uint32> (iter->first.first.size());
+            Ogre::uint64 size = iter->first.second;
+            Ogre::uint32 valueCount = static_cast<Ogre::uint32> (iter->second.size());
+
+            stream.write (reinterpret_cast<const char *> (&nameSize), sizeof (nameSize));
+            stream.write (iter->first.first.data(), nameSize);
+            stream.write (reinterpret_cast<const char *> (&size), sizeof (size));
+            stream.write (reinterpret_cast<const char *> (&valueCount), sizeof (valueCount));
+
+            if (valueCount>0)
+                stream.write (reinterpret_cast<const char *> (&iter->second[0]), valueCount*sizeof (float));
+        }
+
+        if (!stream.good())
+        {
+            std::cerr << "failed to write loudness cache " << mPath << std::endl;
+            stream.close();
+            boost::filesystem::remove (path, error);
+            return;
+        }
+
+        mChanged = false;
+    }
+
+    bool LoudnessCache::get (const std::string& name, std::size_t size, std::vector<float>& out) const
+    {
+        boost::mutex::scoped_lock lock (mMutex);
+
+        EntryMap::const_iterator iter = mEntries.find (Key (name, size));
+
+        if (iter==mEntries.end())
+            return false;
+
+        out = iter->second;
+        return true;
+    }
+
+    void LoudnessCache::insert (const std::string& name, std::size_t size, const std::vector<float>& values)
+    {
+        boost::mutex::scoped_lock lock (mMutex);
+
+        mEntries[Key (name, size)] = values;
+        mChanged = true;
+    }
+
+}
@@ -1,3 +1,12 @@
+#ifndef GAME_SOUND_LOUDNESS_H
+#define GAME_SOUND_LOUDNESS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
 #include "sound_decoder.hpp"
 
 namespace MWSound
@@ -17,4 +26,42 @@ namespace MWSound
 void analyzeLoudness (const std::vector<char>& data, int sampleRate, ChannelConfig chans, SampleType type,
                       std::vector<float>& out, float valuesPerSecond);
 
+/**
+ * Loudness values of previously analyzed sound files, kept on disk between sessions.
+ * Entries are keyed by the file name and the size of the encoded file, so they can be looked
+ * up before the file is decoded.
+ * get() and insert() may be called from any thread.
+ */
+class LoudnessCache
+{
+    typedef std::pair<std::string, std::size_t> Key;
+    typedef std::map<Key, std::vector<float> > EntryMap;
+
+    EntryMap mEntries;
+    std::string mPath;
+    float mValuesPerSecond;
+    bool mChanged;
+    mutable boost::mutex mMutex;
+
+    LoudnessCache (const LoudnessCache&);
+    LoudnessCache& operator= (const LoudnessCache&);
+
+public:
+    LoudnessCache();
+
+    void load (const std::string& path, float valuesPerSecond);
+    ///< Replace the cache content with the one stored in \a path. Files written
+    /// with a different number of values per second are ignored.
+
+    void save();
+    ///< Write the cache back to the file it was loaded from, if anything was added.
+
+    bool get (const std::string& name, std::size_t size, std::vector<float>& out) const;
+    ///< \return Was an entry for \a name with a file of \a size bytes found?
+
+    void insert (const std::string& name, std::size_t size, const std::vector<float>& values);
+};
+
 }
+
+#endif
@@ -28,6 +28,7 @@ namespace MWSound
         virtual void close();
         virtual void rewind();
         virtual std::string getName();
+        virtual size_t getFileSize();
         virtual void getInfo(int *samplerate, ChannelConfig *chans, SampleType *type);
         virtual size_t read(char *buffer, size_t bytes);
         virtual size_t getSampleOffset();
@@ -54,6 +55,11 @@ namespace MWSound
             return mVideoState->stream->getName();
         }
 
+        size_t getStreamSize()
+        {
+            return mVideoState->stream->size();
+        }
+
     private:
         // MovieAudioDecoder overrides
 
@@ -105,6 +111,11 @@ namespace MWSound
         return mDecoder->getStreamName();
     }
 
+    size_t MWSoundDecoderBridge::getFileSize()
+    {
+        return mDecoder->getStreamSize();
+    }
+
     void MWSoundDecoderBridge::getInfo(int *samplerate, ChannelConfig *chans, SampleType *type)
     {
         *samplerate = mDecoder->getOutputSampleRate();
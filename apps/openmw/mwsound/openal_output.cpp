@@ -6,6 +6,7 @@
 #include <stdint.h>
 
 #include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 #include "openal_output.hpp"
 #include "sound_decoder.hpp"
@@ -181,6 +182,13 @@ class OpenAL_SoundStream : public Sound
     volatile bool mIsFinished;
     volatile bool mIsInitialBatchEnqueued;
 
+    // Guards the decoder and the buffer queue against concurrent access from process()
+    boost::mutex mMutex;
+
+    // Managed by the StreamThread
+    boost::system_time mNextUpdate;
+    bool mIsProcessing;
+
     void updateAll(bool local);
 
     OpenAL_SoundStream(const OpenAL_SoundStream &rhs);
@@ -198,70 +206,112 @@ public:
     virtual void update();
 
     void play();
-    bool process();
+
+    /// Refill processed buffers and restart the source if it ran dry.
+    /// @param delay Is set to the time after which the next buffer needs refilling.
+    /// @return Does the stream still need processing?
+    bool process(boost::posix_time::time_duration &delay);
 };
 
 const ALfloat OpenAL_SoundStream::sBufferLength = 0.125f;
 
 //
-// A background streaming thread (keeps active streams processed)
+// Background streaming threads (keep active streams processed). A stream is
+// only processed when its next buffer is about to run out, and by one thread
+// at a time, so several streams can be decoded in parallel.
 //
 struct OpenAL_Output::StreamThread {
     typedef std::vector<OpenAL_SoundStream*> StreamVec;
     StreamVec mStreams;
-    boost::recursive_mutex mMutex;
-    boost::thread mThread;
+    boost::mutex mMutex;
+    boost::condition_variable mCondition; // the stream list or a deadline changed
+    boost::condition_variable mProcessed; // a thread finished processing a stream
+    boost::thread_group mThreads;
 
     StreamThread()
-      : mThread(boost::ref(*this))
     {
+        unsigned int threads = std::min(std::max(boost::thread::hardware_concurrency(), 1u), 2u);
+        for(unsigned int i = 0;i < threads;i++)
+            mThreads.create_thread(boost::bind(&StreamThread::run, this));
     }
     ~StreamThread()
     {
-        mThread.interrupt();
+        mThreads.interrupt_all();
+        mThreads.join_all();
     }
 
-    // boost::thread entry point
-    void operator()()
+    void run()
     {
+        boost::unique_lock<boost::mutex> lock(mMutex);
         while(1)
         {
-            mMutex.lock();
-            StreamVec::iterator iter = mStreams.begin();
-            while(iter != mStreams.end())
+            // Find the stream that runs out of data first
+            OpenAL_SoundStream *next = 0;
+            for(StreamVec::iterator iter = mStreams.begin();iter != mStreams.end();++iter)
+            {
+                if(!(*iter)->mIsProcessing && (!next || (*iter)->mNextUpdate < next->mNextUpdate))
+                    next = *iter;
+            }
+
+            if(!next)
             {
-                if((*iter)->process() == false)
-                    iter = mStreams.erase(iter);
-                else
-                    ++iter;
+                mCondition.wait(lock);
+                continue;
             }
-            mMutex.unlock();
-            boost::this_thread::sleep(boost::posix_time::milliseconds(50));
+            if(next->mNextUpdate > boost::get_system_time())
+            {
+                mCondition.timed_wait(lock, next->mNextUpdate);
+                continue;
+            }
+
+            next->mIsProcessing = true;
+            lock.unlock();
+
+            boost::posix_time::time_duration delay;
+            bool keep = next->process(delay);
+
+            lock.lock();
+            next->mIsProcessing = false;
+            next->mNextUpdate = boost::get_system_time() + delay;
+            if(!keep)
+                mStreams.erase(std::find(mStreams.begin(), mStreams.end(), next));
+            mProcessed.notify_all();
         }
     }
 
     void add(OpenAL_SoundStream *stream)
     {
-        mMutex.lock();
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        stream->mNextUpdate = boost::get_system_time();
         if(std::find(mStreams.begin(), mStreams.end(), stream) == mStreams.end())
             mStreams.push_back(stream);
-        mMutex.unlock();
+        mCondition.notify_one();
     }
 
     void remove(OpenAL_SoundStream *stream)
     {
-        mMutex.lock();
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        while(stream->mIsProcessing)
+            mProcessed.wait(lock);
         StreamVec::iterator iter = std::find(mStreams.begin(), mStreams.end(), stream);
         if(iter != mStreams.end())
             mStreams.erase(iter);
-        mMutex.unlock();
     }
 
     void removeAll()
     {
-        mMutex.lock();
+        boost::unique_lock<boost::mutex> lock(mMutex);
+        for(StreamVec::iterator iter = mStreams.begin();iter != mStreams.end();)
+        {
+            if((*iter)->mIsProcessing)
+            {
+                mProcessed.wait(lock);
+                iter = mStreams.begin();
+            }
+            else
+                ++iter;
+        }
         mStreams.clear();
-        mMutex.unlock();
     }
 
 private:
@@ -270,9 +320,127 @@ private:
 };
 
 
+//
+// A sound file being decoded in the background. The decoder is opened and
+// closed on the main thread, only reading and analyzing happens on a worker.
+//
+struct DecodeJob
+{
+    std::string mName;
+    size_t mFileSize;
+    DecoderPtr mDecoder;
+
+    int mSampleRate;
+    ChannelConfig mChannels;
+    SampleType mType;
+    ALenum mFormat;
+
+    std::vector<char> mData;
+    std::vector<float> mLoudness;
+    std::string mError;
+};
+
+//
+// A pool of background threads decoding sound files for the buffer cache
+//
+struct OpenAL_Output::DecodeThread {
+    typedef std::deque<DecodeJobPtr> JobQueue;
+    JobQueue mQueue;
+    std::vector<DecodeJobPtr> mFinished;
+    boost::mutex mMutex;
+    boost::condition_variable mCondition;
+    boost::thread_group mThreads;
+
+    LoudnessCache &mLoudnessCache;
+
+    DecodeThread(LoudnessCache &loudnessCache)
+      : mLoudnessCache(loudnessCache)
+    {
+        // Leave one core to the main thread, but don't hog a big machine for short sound effects
+        unsigned int cores = boost::thread::hardware_concurrency();
+        unsigned int threads = std::min(std::max(cores, 2u)-1, 4u);
+
+        for(unsigned int i = 0;i < threads;i++)
+            mThreads.create_thread(boost::bind(&DecodeThread::run, this));
+    }
+    ~DecodeThread()
+    {
+        mThreads.interrupt_all();
+        mThreads.join_all();
+    }
+
+    void run()
+    {
+        while(1)
+        {
+            DecodeJobPtr job;
+            {
+                boost::unique_lock<boost::mutex> lock(mMutex);
+                while(mQueue.empty())
+                    mCondition.wait(lock);
+                job = mQueue.front();
+                mQueue.pop_front();
+            }
+
+            decode(*job);
+
+            boost::lock_guard<boost::mutex> lock(mMutex);
+            mFinished.push_back(job);
+        }
+    }
+
+    void decode(DecodeJob &job)
+    {
+        try
+        {
+            bool cached = mLoudnessCache.get(job.mName, job.mFileSize, job.mLoudness);
+
+            job.mDecoder->readAll(job.mData);
+
+            if(!cached)
+            {
+                analyzeLoudness(job.mData, job.mSampleRate, job.mChannels, job.mType,
+                                job.mLoudness, static_cast<float>(loudnessFPS));
+                mLoudnessCache.insert(job.mName, job.mFileSize, job.mLoudness);
+            }
+        }
+        catch(std::exception &e)
+        {
+            job.mError = e.what();
+        }
+    }
+
+    void add(DecodeJobPtr job)
+    {
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        mQueue.push_back(job);
+        mCondition.notify_one();
+    }
+
+    /// Move the jobs that finished since the last call to \a jobs.
+    void collect(std::vector<DecodeJobPtr> &jobs)
+    {
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        jobs.swap(mFinished);
+    }
+
+    void removeAll()
+    {
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        mQueue.clear();
+        mFinished.clear();
+    }
+
+private:
+    DecodeThread(const DecodeThread &rhs);
+    DecodeThread& operator=(const DecodeThread &rhs);
+};
+
+
 OpenAL_SoundStream::OpenAL_SoundStream(OpenAL_Output &output, ALuint src, DecoderPtr decoder, float basevol, float pitch, int flags)
   : Sound(Ogre::Vector3(0.0f), 1.0f, basevol, pitch, 1.0f, 1000.0f, flags)
   , mOutput(output), mSource(src), mSamplesQueued(0), mDecoder(decoder), mIsFinished(true), mIsInitialBatchEnqueued(false)
+  , mNextUpdate(boost::get_system_time()), mIsProcessing(false)
 {
     throwALerror();
 
@@ -360,14 +528,14 @@ double OpenAL_SoundStream::getTimeOffset()
     ALfloat offset = 0.0f;
     double t;
 
-    mOutput.mStreamThread->mMutex.lock();
+    mMutex.lock();
     alGetSourcef(mSource, AL_SEC_OFFSET, &offset);
     alGetSourcei(mSource, AL_SOURCE_STATE, &state);
     if(state == AL_PLAYING || state == AL_PAUSED)
         t = (double)(mDecoder->getSampleOffset() - mSamplesQueued)/(double)mSampleRate + offset;
     else
         t = (double)mDecoder->getSampleOffset() / (double)mSampleRate;
-    mOutput.mStreamThread->mMutex.unlock();
+    mMutex.unlock();
 
     throwALerror();
     return t;
@@ -410,8 +578,13 @@ void OpenAL_SoundStream::update()
     throwALerror();
 }
 
-bool OpenAL_SoundStream::process()
+bool OpenAL_SoundStream::process(boost::posix_time::time_duration &delay)
 {
+    boost::lock_guard<boost::mutex> lock(mMutex);
+
+    // Check back after one buffer length unless the source tells us otherwise
+    double seconds = sBufferLength;
+
     try {
         bool finished = mIsFinished;
         ALint processed, state;
@@ -470,10 +643,27 @@ bool OpenAL_SoundStream::process()
 
             alGetSourcei(mSource, AL_BUFFERS_QUEUED, &queued);
             if(queued > 0)
+            {
                 alSourcePlay(mSource);
+                state = AL_PLAYING;
+            }
             throwALerror();
         }
 
+        if(state == AL_PLAYING)
+        {
+            // Wake up when the oldest queued buffer is done, so it can be refilled right away
+            ALint offset = 0;
+            alGetSourcei(mSource, AL_SAMPLE_OFFSET, &offset);
+            throwALerror();
+
+            ALint bufferSamples = std::max(static_cast<ALint>(sBufferLength*mSampleRate), 1);
+            ALint remaining = std::max(bufferSamples - offset%bufferSamples, 0);
+            seconds = static_cast<double>(remaining) / mSampleRate;
+            if(mPitch > 0.0f)
+                seconds /= mPitch;
+        }
+
         mIsFinished = finished;
     }
     catch(std::exception&) {
@@ -482,6 +672,10 @@ bool OpenAL_SoundStream::process()
         mIsFinished = true;
         mIsInitialBatchEnqueued = false;
     }
+
+    seconds = std::min(std::max(seconds, 0.005), static_cast<double>(sBufferLength));
+    delay = boost::posix_time::microseconds(static_cast<boost::int64_t>(seconds*1000000.0));
+
     return !mIsFinished;
 }
 
@@ -495,17 +689,23 @@ protected:
 
     ALuint mSource;
     ALuint mBuffer;
+    CachedSound *mCached;
+
+    bool mPending; // waiting for the buffer to finish decoding
+    bool mExtractLoudness;
+    float mOffset;
 
     friend class OpenAL_Output;
 
     void updateAll(bool local);
+    void play(const CachedSound &cached);
 
 private:
     OpenAL_Sound(const OpenAL_Sound &rhs);
     OpenAL_Sound& operator=(const OpenAL_Sound &rhs);
 
 public:
-    OpenAL_Sound(OpenAL_Output &output, ALuint src, ALuint buf, const Ogre::Vector3& pos, float vol, float basevol, float pitch, float mindist, float maxdist, int flags);
+    OpenAL_Sound(OpenAL_Output &output, ALuint src, CachedSound &cached, const Ogre::Vector3& pos, float vol, float basevol, float pitch, float mindist, float maxdist, int flags);
     virtual ~OpenAL_Sound();
 
     virtual void stop();
@@ -524,16 +724,16 @@ class OpenAL_Sound3D : public OpenAL_Sound
     OpenAL_Sound3D& operator=(const OpenAL_Sound &rhs);
 
 public:
-    OpenAL_Sound3D(OpenAL_Output &output, ALuint src, ALuint buf, const Ogre::Vector3& pos, float vol, float basevol, float pitch, float mindist, float maxdist, int flags)
-      : OpenAL_Sound(output, src, buf, pos, vol, basevol, pitch, mindist, maxdist, flags)
+    OpenAL_Sound3D(OpenAL_Output &output, ALuint src, CachedSound &cached, const Ogre::Vector3& pos, float vol, float basevol, float pitch, float mindist, float maxdist, int flags)
+      : OpenAL_Sound(output, src, cached, pos, vol, basevol, pitch, mindist, maxdist, flags)
     { }
 
     virtual void update();
 };
 
-OpenAL_Sound::OpenAL_Sound(OpenAL_Output &output, ALuint src, ALuint buf, const Ogre::Vector3& pos, float vol, float basevol, float pitch, float mindist, float maxdist, int flags)
+OpenAL_Sound::OpenAL_Sound(OpenAL_Output &output, ALuint src, CachedSound &cached, const Ogre::Vector3& pos, float vol, float basevol, float pitch, float mindist, float maxdist, int flags)
   : Sound(pos, vol, basevol, pitch, mindist, maxdist, flags)
-  , mOutput(output), mSource(src), mBuffer(buf)
+  , mOutput(output), mSource(src), mBuffer(cached.mALBuffer), mCached(&cached), mPending(false), mExtractLoudness(false), mOffset(0.0f)
 {
     mOutput.mActiveSounds.push_back(this);
 }
@@ -543,20 +743,37 @@ OpenAL_Sound::~OpenAL_Sound()
     alSourcei(mSource, AL_BUFFER, 0);
 
     mOutput.mFreeSources.push_back(mSource);
-    mOutput.bufferFinished(mBuffer);
+    if(mCached)
+        mOutput.bufferFinished(*mCached);
 
     mOutput.mActiveSounds.erase(std::find(mOutput.mActiveSounds.begin(),
                                           mOutput.mActiveSounds.end(), this));
 }
 
+void OpenAL_Sound::play(const CachedSound &cached)
+{
+    mPending = false;
+    if(mExtractLoudness)
+        setLoudnessVector(cached.mLoudnessVector, static_cast<float>(loudnessFPS));
+
+    alSourcei(mSource, AL_BUFFER, mBuffer);
+    alSourcef(mSource, AL_SEC_OFFSET, static_cast<ALfloat>(getLength()*mOffset / mPitch));
+    alSourcePlay(mSource);
+    throwALerror();
+}
+
 void OpenAL_Sound::stop()
 {
+    mPending = false;
     alSourceStop(mSource);
     throwALerror();
 }
 
 bool OpenAL_Sound::isPlaying()
 {
+    if(mPending)
+        return true;
+
     ALint state;
 
     alGetSourcei(mSource, AL_SOURCE_STATE, &state);
@@ -577,6 +794,9 @@ double OpenAL_Sound::getTimeOffset()
 
 double OpenAL_Sound::getLength()
 {
+    if(!mBuffer || mPending)
+        return 0.0;
+
     ALint bufferSize, frequency, channels, bitsPerSample;
     alGetBufferi(mBuffer, AL_SIZE, &bufferSize);
     alGetBufferi(mBuffer, AL_FREQUENCY, &frequency);
@@ -724,19 +944,36 @@ void OpenAL_Output::init(const std::string &devname)
     if(mFreeSources.empty())
         fail("Could not allocate any sources");
 
+    mBufferPools[Pool_Sfx].mMaxMemSize = static_cast<uint64_t>(
+        std::max(0.0f, Settings::Manager::getFloat("sfx cache size", "Sound")) * 1024*1024);
+    mBufferPools[Pool_Voice].mMaxMemSize = static_cast<uint64_t>(
+        std::max(0.0f, Settings::Manager::getFloat("voice cache size", "Sound")) * 1024*1024);
+
+    if(!mManager.mCacheDir.empty())
+        mLoudnessCache.load(mManager.mCacheDir+"/loudness.cache", static_cast<float>(loudnessFPS));
+
     mInitialized = true;
 }
 
 void OpenAL_Output::deinit()
 {
     mStreamThread->removeAll();
+    mDecodeThread->removeAll();
 
     for(size_t i = 0;i < mFreeSources.size();i++)
         alDeleteSources(1, &mFreeSources[i]);
     mFreeSources.clear();
 
-    mBufferRefs.clear();
-    mUnusedBuffers.clear();
+    static const char *poolNames[Pool_Count] = { "sfx", "voice" };
+    for(int i = 0;i < Pool_Count;i++)
+    {
+        BufferPool &pool = mBufferPools[i];
+        if(pool.mHits || pool.mMisses)
+            std::cout <<"Sound buffer cache ("<<poolNames[i]<<"): "<<pool.mHits<<" hits, "
+                      <<pool.mMisses<<" misses, "<<pool.mEvictions<<" evictions"<< std::endl;
+        pool.mOldest = pool.mNewest = 0;
+        pool.mMemSize = 0;
+    }
     while(!mBufferCache.empty())
     {
         alDeleteBuffers(1, &mBufferCache.begin()->second.mALBuffer);
@@ -751,35 +988,32 @@ void OpenAL_Output::deinit()
         alcCloseDevice(mDevice);
     mDevice = 0;
 
+    mLoudnessCache.save();
+
     mInitialized = false;
 }
 
 
-const CachedSound& OpenAL_Output::getBuffer(const std::string &fname)
+CachedSound& OpenAL_Output::getBuffer(const std::string &fname, int flags)
 {
     ALuint buf = 0;
 
+    BufferPool &pool = mBufferPools[(flags&MWBase::SoundManager::Play_TypeMask) == MWBase::SoundManager::Play_TypeVoice ?
+                                    Pool_Voice : Pool_Sfx];
+
     NameMap::iterator iditer = mBufferCache.find(fname);
     if(iditer != mBufferCache.end())
     {
-        buf = iditer->second.mALBuffer;
-        if(mBufferRefs[buf]++ == 0)
-        {
-            IDDq::iterator iter = std::find(mUnusedBuffers.begin(),
-                                            mUnusedBuffers.end(), buf);
-            if(iter != mUnusedBuffers.end())
-                mUnusedBuffers.erase(iter);
-        }
+        CachedSound &cached = iditer->second;
+        if(cached.mRefs++ == 0)
+            removeUnused(cached);
+        ++mBufferPools[cached.mPool].mHits;
 
-        return iditer->second;
+        return cached;
     }
     throwALerror();
 
-    std::vector<char> data;
-    ChannelConfig chans;
-    SampleType type;
-    ALenum format;
-    int srate;
+    ++pool.mMisses;
 
     DecoderPtr decoder = mManager.getDecoder();
     try
@@ -794,70 +1028,174 @@ const CachedSound& OpenAL_Output::getBuffer(const std::string &fname)
         decoder->open(fname.substr(0, pos)+".mp3");
     }
 
-    decoder->getInfo(&srate, &chans, &type);
-    format = getALFormat(chans, type);
-
-    decoder->readAll(data);
-    decoder->close();
-
-    CachedSound cached;
-    analyzeLoudness(data, srate, chans, type, cached.mLoudnessVector, static_cast<float>(loudnessFPS));
+    DecodeJobPtr job(new DecodeJob);
+    job->mName = fname;
+    job->mFileSize = decoder->getFileSize();
+    job->mDecoder = decoder;
+    decoder->getInfo(&job->mSampleRate, &job->mChannels, &job->mType);
+    job->mFormat = getALFormat(job->mChannels, job->mType);
 
     alGenBuffers(1, &buf);
     throwALerror();
 
-    alBufferData(buf, format, &data[0], data.size(), srate);
-    mBufferRefs[buf] = 1;
+    CachedSound &cached = mBufferCache[fname];
+    cached.mName = fname;
     cached.mALBuffer = buf;
-    mBufferCache[fname] = cached;
+    cached.mPending = job;
+    cached.mPool = static_cast<int>(&pool - mBufferPools);
+    cached.mRefs = 1;
+
+    mDecodeThread->add(job);
 
-    ALint bufsize = 0;
-    alGetBufferi(buf, AL_SIZE, &bufsize);
-    mBufferCacheMemSize += bufsize;
+    return cached;
+}
+
+void OpenAL_Output::addUnused(CachedSound &cached)
+{
+    BufferPool &pool = mBufferPools[cached.mPool];
+
+    cached.mPrevUnused = pool.mNewest;
+    cached.mNextUnused = 0;
+    if(pool.mNewest)
+        pool.mNewest->mNextUnused = &cached;
+    else
+        pool.mOldest = &cached;
+    pool.mNewest = &cached;
+}
+
+void OpenAL_Output::removeUnused(CachedSound &cached)
+{
+    BufferPool &pool = mBufferPools[cached.mPool];
 
-    // NOTE: Max buffer cache: 15MB
-    while(mBufferCacheMemSize > 15*1024*1024)
+    if(cached.mPrevUnused)
+        cached.mPrevUnused->mNextUnused = cached.mNextUnused;
+    else
+        pool.mOldest = cached.mNextUnused;
+    if(cached.mNextUnused)
+        cached.mNextUnused->mPrevUnused = cached.mPrevUnused;
+    else
+        pool.mNewest = cached.mPrevUnused;
+
+    cached.mPrevUnused = cached.mNextUnused = 0;
+}
+
+void OpenAL_Output::deleteBuffer(CachedSound &cached)
+{
+    if(cached.mRefs == 0)
+        removeUnused(cached);
+    mBufferPools[cached.mPool].mMemSize -= cached.mSize;
+
+    alDeleteBuffers(1, &cached.mALBuffer);
+    alGetError();
+
+    mBufferCache.erase(mBufferCache.find(cached.mName));
+}
+
+void OpenAL_Output::trimBufferCache(BufferPool &pool)
+{
+    while(pool.mMemSize > pool.mMaxMemSize)
     {
-        if(mUnusedBuffers.empty())
+        if(!pool.mOldest)
         {
             std::cout <<"No more unused buffers to clear!"<< std::endl;
             break;
         }
 
-        ALuint oldbuf = mUnusedBuffers.front();
-        mUnusedBuffers.pop_front();
+        deleteBuffer(*pool.mOldest);
+        ++pool.mEvictions;
+    }
+}
+
+void OpenAL_Output::finishDecoding()
+{
+    std::vector<DecodeJobPtr> finished;
+    mDecodeThread->collect(finished);
+
+    if(finished.empty())
+        return;
+
+    for(std::vector<DecodeJobPtr>::iterator jobiter = finished.begin();jobiter != finished.end();++jobiter)
+    {
+        DecodeJob &job = **jobiter;
+        job.mDecoder->close();
+
+        // The entry may have been evicted or replaced while the job was running
+        NameMap::iterator nameiter = mBufferCache.find(job.mName);
+        if(nameiter == mBufferCache.end() || nameiter->second.mPending != *jobiter)
+            continue;
+
+        CachedSound &cached = nameiter->second;
+        BufferPool &pool = mBufferPools[cached.mPool];
+        ALuint buf = cached.mALBuffer;
+        cached.mPending.reset();
 
-        NameMap::iterator nameiter = mBufferCache.begin();
-        while(nameiter != mBufferCache.end())
+        if(job.mError.empty() && !job.mData.empty())
         {
-            if(nameiter->second.mALBuffer == oldbuf)
-                mBufferCache.erase(nameiter++);
-            else
-                ++nameiter;
+            alBufferData(buf, job.mFormat, &job.mData[0], job.mData.size(), job.mSampleRate);
+            if(alGetError() != AL_NO_ERROR)
+                job.mError = "Failed to upload sound data";
         }
+        else if(job.mError.empty())
+            job.mError = "No sound data";
+
+        if(!job.mError.empty())
+        {
+            std::cout <<"Sound Error: \""<<job.mName<<"\": "<<job.mError<< std::endl;
+
+            // Forget about the buffer, so the next request tries again
+            for(SoundVec::iterator iter = mActiveSounds.begin();iter != mActiveSounds.end();++iter)
+            {
+                OpenAL_Sound *sound = dynamic_cast<OpenAL_Sound*>(*iter);
+                if(sound && sound->mCached == &cached)
+                {
+                    sound->mPending = false;
+                    sound->mBuffer = 0;
+                    sound->mCached = 0;
+                }
+            }
+            deleteBuffer(cached);
+            continue;
+        }
+
+        cached.mLoudnessVector.swap(job.mLoudness);
+
+        alGetBufferi(buf, AL_SIZE, &cached.mSize);
+        pool.mMemSize += cached.mSize;
 
-        bufsize = 0;
-        alGetBufferi(oldbuf, AL_SIZE, &bufsize);
-        alDeleteBuffers(1, &oldbuf);
-        mBufferCacheMemSize -= bufsize;
+        for(SoundVec::iterator iter = mActiveSounds.begin();iter != mActiveSounds.end();++iter)
+        {
+            OpenAL_Sound *sound = dynamic_cast<OpenAL_Sound*>(*iter);
+            if(!sound || !sound->mPending || sound->mCached != &cached)
+                continue;
+
+            try
+            {
+                sound->play(cached);
+                if(sound->getPlayType() & mPausedTypes)
+                    alSourcePause(sound->mSource);
+            }
+            catch(std::exception &e)
+            {
+                std::cout <<"Sound Error: "<<e.what()<< std::endl;
+            }
+        }
     }
 
-    return mBufferCache[fname];
+    for(int i = 0;i < Pool_Count;i++)
+        trimBufferCache(mBufferPools[i]);
 }
 
-void OpenAL_Output::bufferFinished(ALuint buf)
+void OpenAL_Output::bufferFinished(CachedSound &cached)
 {
-    if(mBufferRefs.at(buf)-- == 1)
-    {
-        mBufferRefs.erase(mBufferRefs.find(buf));
-        mUnusedBuffers.push_back(buf);
-    }
+    if(--cached.mRefs == 0)
+        addUnused(cached);
 }
 
 MWBase::SoundPtr OpenAL_Output::playSound(const std::string &fname, float vol, float basevol, float pitch, int flags,float offset)
 {
     boost::shared_ptr<OpenAL_Sound> sound;
-    ALuint src=0, buf=0;
+    CachedSound *cached = 0;
+    ALuint src=0;
 
     if(mFreeSources.empty())
         fail("No free sources");
@@ -866,29 +1204,33 @@ MWBase::SoundPtr OpenAL_Output::playSound(const std::string &fname, float vol, f
 
     try
     {
-        buf = getBuffer(fname).mALBuffer;
-        sound.reset(new OpenAL_Sound(*this, src, buf, Ogre::Vector3(0.0f), vol, basevol, pitch, 1.0f, 1000.0f, flags));
+        cached = &getBuffer(fname, flags);
+        sound.reset(new OpenAL_Sound(*this, src, *cached, Ogre::Vector3(0.0f), vol, basevol, pitch, 1.0f, 1000.0f, flags));
+
+        sound->updateAll(true);
+        if(offset<0)
+            offset=0;
+        if(offset>1)
+            offset=1;
+        sound->mOffset = offset;
+
+        if(cached->mPending)
+            sound->mPending = true;
+        else
+            sound->play(*cached);
     }
     catch(std::exception&)
     {
-        mFreeSources.push_back(src);
-        if(buf && alIsBuffer(buf))
-            bufferFinished(buf);
+        if(!sound)
+        {
+            mFreeSources.push_back(src);
+            if(cached)
+                bufferFinished(*cached);
+        }
         alGetError();
         throw;
     }
 
-    sound->updateAll(true);
-    if(offset<0)
-        offset=0;
-    if(offset>1)
-        offset=1;
-
-    alSourcei(src, AL_BUFFER, buf);
-    alSourcef(src, AL_SEC_OFFSET, static_cast<ALfloat>(sound->getLength()*offset / pitch));
-    alSourcePlay(src);
-    throwALerror();
-
     return sound;
 }
 
@@ -896,7 +1238,8 @@ MWBase::SoundPtr OpenAL_Output::playSound3D(const std::string &fname, const Ogre
                                             float min, float max, int flags, float offset, bool extractLoudness)
 {
     boost::shared_ptr<OpenAL_Sound> sound;
-    ALuint src=0, buf=0;
+    CachedSound *cached = 0;
+    ALuint src=0;
 
     if(mFreeSources.empty())
         fail("No free sources");
@@ -905,35 +1248,35 @@ MWBase::SoundPtr OpenAL_Output::playSound3D(const std::string &fname, const Ogre
 
     try
     {
-        const CachedSound& cached = getBuffer(fname);
-        buf = cached.mALBuffer;
+        cached = &getBuffer(fname, flags);
+
+        sound.reset(new OpenAL_Sound3D(*this, src, *cached, pos, vol, basevol, pitch, min, max, flags));
+        sound->mExtractLoudness = extractLoudness;
+
+        sound->updateAll(false);
+        if(offset<0)
+            offset=0;
+        if(offset>1)
+            offset=1;
+        sound->mOffset = offset;
 
-        sound.reset(new OpenAL_Sound3D(*this, src, buf, pos, vol, basevol, pitch, min, max, flags));
-        if (extractLoudness)
-            sound->setLoudnessVector(cached.mLoudnessVector, static_cast<float>(loudnessFPS));
+        if(cached->mPending)
+            sound->mPending = true;
+        else
+            sound->play(*cached);
     }
     catch(std::exception&)
     {
-        mFreeSources.push_back(src);
-        if(buf && alIsBuffer(buf))
-            bufferFinished(buf);
+        if(!sound)
+        {
+            mFreeSources.push_back(src);
+            if(cached)
+                bufferFinished(*cached);
+        }
         alGetError();
         throw;
     }
 
-    sound->updateAll(false);
-
-    if(offset<0)
-        offset=0;
-    if(offset>1)
-        offset=1;
-
-    alSourcei(src, AL_BUFFER, buf);
-    alSourcef(src, AL_SEC_OFFSET, static_cast<ALfloat>(sound->getLength()*offset / pitch));
-
-    alSourcePlay(src);
-    throwALerror();
-
     return sound;
 }
 
@@ -987,6 +1330,8 @@ void OpenAL_Output::updateListener(const Ogre::Vector3 &pos, const Ogre::Vector3
 
 void OpenAL_Output::pauseSounds(int types)
 {
+    mPausedTypes |= types;
+
     std::vector<ALuint> sources;
     SoundVec::const_iterator iter = mActiveSounds.begin();
     while(iter != mActiveSounds.end())
@@ -1000,7 +1345,7 @@ void OpenAL_Output::pauseSounds(int types)
         else
         {
             const OpenAL_Sound *sound = dynamic_cast<OpenAL_Sound*>(*iter);
-            if(sound && sound->mSource && (sound->getPlayType()&types))
+            if(sound && sound->mSource && !sound->mPending && (sound->getPlayType()&types))
                 sources.push_back(sound->mSource);
         }
         ++iter;
@@ -1014,6 +1359,8 @@ void OpenAL_Output::pauseSounds(int types)
 
 void OpenAL_Output::resumeSounds(int types)
 {
+    mPausedTypes &= ~types;
+
     std::vector<ALuint> sources;
     SoundVec::const_iterator iter = mActiveSounds.begin();
     while(iter != mActiveSounds.end())
@@ -1027,7 +1374,7 @@ void OpenAL_Output::resumeSounds(int types)
         else
         {
             const OpenAL_Sound *sound = dynamic_cast<OpenAL_Sound*>(*iter);
-            if(sound && sound->mSource && (sound->getPlayType()&types))
+            if(sound && sound->mSource && !sound->mPending && (sound->getPlayType()&types))
                 sources.push_back(sound->mSource);
         }
         ++iter;
@@ -1041,8 +1388,9 @@ void OpenAL_Output::resumeSounds(int types)
 
 
 OpenAL_Output::OpenAL_Output(SoundManager &mgr)
-  : Sound_Output(mgr), mDevice(0), mContext(0), mBufferCacheMemSize(0),
-    mLastEnvironment(Env_Normal), mStreamThread(new StreamThread)
+  : Sound_Output(mgr), mDevice(0), mContext(0), mPausedTypes(0),
+    mLastEnvironment(Env_Normal), mStreamThread(new StreamThread),
+    mDecodeThread(new DecodeThread(mLoudnessCache))
 {
 }
 
@@ -6,20 +6,59 @@
 #include <map>
 #include <deque>
 
+#include <boost/shared_ptr.hpp>
+
 #include "alc.h"
 #include "al.h"
 
 #include "sound_output.hpp"
+#include "loudness.hpp"
 
 namespace MWSound
 {
     class SoundManager;
     class Sound;
+    class OpenAL_Sound;
+
+    struct DecodeJob;
+    typedef boost::shared_ptr<DecodeJob> DecodeJobPtr;
 
     struct CachedSound
     {
+        std::string mName;
         ALuint mALBuffer;
         std::vector<float> mLoudnessVector;
+        DecodeJobPtr mPending; ///< Set while the sample data is still being decoded.
+
+        int mPool;
+        ALint mSize;
+        int mRefs; ///< Number of sounds using the buffer. Unused buffers are kept in their pool's LRU list.
+
+        CachedSound *mPrevUnused;
+        CachedSound *mNextUnused;
+
+        CachedSound()
+          : mALBuffer(0), mPool(0), mSize(0), mRefs(0), mPrevUnused(0), mNextUnused(0)
+        { }
+    };
+
+    /// Cached buffers of one kind of sound, e.g. short effects or long voice lines, with
+    /// a memory budget of their own.
+    struct BufferPool
+    {
+        CachedSound *mOldest; ///< Least recently used of the unused buffers, evicted first
+        CachedSound *mNewest;
+
+        uint64_t mMemSize;
+        uint64_t mMaxMemSize;
+
+        unsigned int mHits;
+        unsigned int mMisses;
+        unsigned int mEvictions;
+
+        BufferPool()
+          : mOldest(0), mNewest(0), mMemSize(0), mMaxMemSize(0), mHits(0), mMisses(0), mEvictions(0)
+        { }
     };
 
     class OpenAL_Output : public Sound_Output
@@ -29,21 +68,33 @@ namespace MWSound
 
         typedef std::deque<ALuint> IDDq;
         IDDq mFreeSources;
-        IDDq mUnusedBuffers;
 
         typedef std::map<std::string,CachedSound> NameMap;
         NameMap mBufferCache;
 
-        typedef std::map<ALuint,ALuint> IDRefMap;
-        IDRefMap mBufferRefs;
-
-        uint64_t mBufferCacheMemSize;
+        enum PoolType
+        {
+            Pool_Sfx,
+            Pool_Voice,
+            Pool_Count
+        };
+        BufferPool mBufferPools[Pool_Count];
 
         typedef std::vector<Sound*> SoundVec;
         SoundVec mActiveSounds;
 
-        const CachedSound& getBuffer(const std::string &fname);
-        void bufferFinished(ALuint buffer);
+        int mPausedTypes;
+
+        /// Returns the cache entry for \a fname. If the file has not been decoded yet, its decoding
+        /// is started in the background and the entry's mPending is set until finishDecoding()
+        /// picked up the result.
+        CachedSound& getBuffer(const std::string &fname, int flags);
+        void bufferFinished(CachedSound &cached);
+        void trimBufferCache(BufferPool &pool);
+        void deleteBuffer(CachedSound &cached);
+
+        void addUnused(CachedSound &cached);
+        void removeUnused(CachedSound &cached);
 
         Environment mLastEnvironment;
 
@@ -63,6 +114,8 @@ namespace MWSound
         virtual void pauseSounds(int types);
         virtual void resumeSounds(int types);
 
+        virtual void finishDecoding();
+
         OpenAL_Output& operator=(const OpenAL_Output &rhs);
         OpenAL_Output(const OpenAL_Output &rhs);
 
@@ -72,6 +125,11 @@ namespace MWSound
         struct StreamThread;
         std::auto_ptr<StreamThread> mStreamThread;
 
+        LoudnessCache mLoudnessCache;
+
+        struct DecodeThread;
+        std::auto_ptr<DecodeThread> mDecodeThread;
+
         friend class OpenAL_Sound;
         friend class OpenAL_Sound3D;
         friend class OpenAL_SoundStream;
@@ -34,6 +34,7 @@ namespace MWSound
         virtual void close() = 0;
 
         virtual std::string getName() = 0;
+        virtual size_t getFileSize() = 0; ///< size of the encoded file
         virtual void getInfo(int *samplerate, ChannelConfig *chans, SampleType *type) = 0;
 
         virtual size_t read(char *buffer, size_t bytes) = 0;
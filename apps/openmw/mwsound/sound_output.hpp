@@ -36,6 +36,9 @@ namespace MWSound
         virtual void pauseSounds(int types) = 0;
         virtual void resumeSounds(int types) = 0;
 
+        /// Start playback of sounds whose data finished decoding in the background.
+        virtual void finishDecoding() = 0;
+
         Sound_Output& operator=(const Sound_Output &rhs);
         Sound_Output(const Sound_Output &rhs);
 
@@ -27,8 +27,9 @@
 
 namespace MWSound
 {
-    SoundManager::SoundManager(bool useSound)
+    SoundManager::SoundManager(bool useSound, const std::string& cacheDir)
         : mResourceMgr(Ogre::ResourceGroupManager::getSingleton())
+        , mCacheDir(cacheDir)
         , mOutput(new DEFAULT_OUTPUT(*this))
         , mMasterVolume(1.0f)
         , mSFXVolume(1.0f)
@@ -41,6 +42,8 @@ namespace MWSound
         , mListenerUp(0,0,1)
         , mListenerUnderwater(false)
     {
+        Settings::Manager::addListener(this, "Sound");
+
         if(!useSound)
             return;
 
@@ -87,6 +90,8 @@ namespace MWSound
 
     SoundManager::~SoundManager()
     {
+        Settings::Manager::removeListener(this);
+
         mUnderwaterSound.reset();
         mActiveSounds.clear();
         mMusic.reset();
@@ -686,6 +691,8 @@ namespace MWSound
         if(!mOutput->isInitialized())
             return;
 
+        mOutput->finishDecoding();
+
         if (MWBase::Environment::get().getStateManager()->getState()!=
             MWBase::StateManager::State_NoGame)
         {
@@ -695,7 +702,7 @@ namespace MWSound
     }
 
 
-    void SoundManager::processChangedSettings(const Settings::CategorySettingVector& settings)
+    void SoundManager::settingsChanged(const Settings::CategorySettingVector& settings)
     {
         mMasterVolume = Settings::Manager::getFloat("master volume", "Sound");
         mMusicVolume = Settings::Manager::getFloat("music volume", "Sound");
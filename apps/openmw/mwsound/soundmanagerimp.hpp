@@ -25,10 +25,12 @@ namespace MWSound
         Env_Underwater
     };
 
-    class SoundManager : public MWBase::SoundManager
+    class SoundManager : public MWBase::SoundManager, public Settings::Listener
     {
         Ogre::ResourceGroupManager& mResourceMgr;
 
+        std::string mCacheDir;
+
         std::auto_ptr<Sound_Output> mOutput;
 
         // Caches available music tracks by <playlist name, (sound files) >
@@ -74,10 +76,11 @@ namespace MWSound
         friend class OpenAL_Output;
 
     public:
-        SoundManager(bool useSound);
+        SoundManager(bool useSound, const std::string& cacheDir);
         virtual ~SoundManager();
 
-        virtual void processChangedSettings(const Settings::CategorySettingVector& settings);
+        virtual void settingsChanged(const Settings::CategorySettingVector& settings);
+        ///< Called for changes in the Sound category
 
         virtual void stopMusic();
         ///< Stops music if it's playing
@@ -35,6 +35,7 @@
 #include "../mwmechanics/creaturestats.hpp"
 
 #include "../mwscript/globalscripts.hpp"
+#include "../mwscript/scriptprofiler.hpp"
 
 void MWState::StateManager::cleanup (bool force)
 {
@@ -44,6 +45,7 @@ void MWState::StateManager::cleanup (bool force)
         MWBase::Environment::get().getDialogueManager()->clear();
         MWBase::Environment::get().getJournal()->clear();
         MWBase::Environment::get().getScriptManager()->getGlobalScripts().clear();
+        MWBase::Environment::get().getScriptManager()->getProfiler().clear(); // one session per profile
         MWBase::Environment::get().getWorld()->clear();
         MWBase::Environment::get().getWindowManager()->clear();
         MWBase::Environment::get().getInputManager()->clear();
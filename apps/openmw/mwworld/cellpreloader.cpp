@@ -0,0 +1,406 @@
+#include "cellpreloader.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+#include <OgreImage.h>
+#include <OgreResourceGroupManager.h>
+#include <OgreTextureManager.h>
+
+#include <components/esm/loadland.hpp>
+#include <components/nif/controlled.hpp>
+#include <components/misc/resourcehelpers.hpp>
+#include <components/misc/stringops.hpp>
+#include <components/misc/profiler.hpp>
+#include <components/nifcache/nifcache.hpp>
+
+#include "../mwbase/environment.hpp"
+#include "../mwbase/world.hpp"
+
+#include "../mwrender/terrainstorage.hpp"
+
+#include "physicssystem.hpp"
+#include "cellstore.hpp"
+#include "class.hpp"
+#include "esmstore.hpp"
+
+namespace
+{
+    // Work done on the main thread per frame, so that preloading never causes a hitch itself
+    const unsigned int sShapesPerFrame = 4;
+    const unsigned int sTexturesPerFrame = 2;
+
+    struct ListModelsFunctor
+    {
+        std::vector<std::pair<std::string, float> > mModels; // model and scale
+
+        bool operator() (const MWWorld::Ptr& ptr)
+        {
+            if (ptr.getRefData().isDeleted() || !ptr.getRefData().isEnabled())
+                return true;
+
+            std::string model = ptr.getClass().getModel (ptr);
+
+            if (!model.empty())
+            {
+                // actors do not use collision shapes of their own model; the scale matches the
+                // clamping done when the cell is inserted into the scene
+                float scale = ptr.getClass().isActor() ? 0 :
+                    std::min (std::max (ptr.getCellRef().getScale(), 0.5f), 2.f);
+
+                mModels.push_back (std::make_pair (model, scale));
+            }
+
+            return true;
+        }
+    };
+}
+
+namespace MWWorld
+{
+    struct CellPreloader::Job
+    {
+        enum Type
+        {
+            Type_Mesh,
+            Type_Texture
+        };
+
+        Type mType;
+        std::string mName;
+        Ogre::DataStreamPtr mStream;
+
+        Nif::NIFFilePtr mMesh;
+        std::vector<std::string> mTextures; // external textures used by mMesh
+
+        std::string mExtension;
+        Ogre::Image mImage;
+
+        std::string mError;
+    };
+
+    //
+    // A pool of background threads parsing meshes and decoding textures
+    //
+    class CellPreloader::WorkerThreads
+    {
+            typedef std::deque<JobPtr> JobQueue;
+            JobQueue mQueue;
+            std::vector<JobPtr> mFinished;
+            boost::mutex mMutex;
+            boost::condition_variable mCondition;
+            boost::thread_group mThreads;
+
+            WorkerThreads (const WorkerThreads&);
+            WorkerThreads& operator= (const WorkerThreads&);
+
+            void run()
+            {
+                while (true)
+                {
+                    JobPtr job;
+                    {
+                        boost::unique_lock<boost::mutex> lock (mMutex);
+                        while (mQueue.empty())
+                            mCondition.wait (lock);
+                        job = mQueue.front();
+                        mQueue.pop_front();
+                    }
+
+                    process (*job);
+
+                    boost::lock_guard<boost::mutex> lock (mMutex);
+                    mFinished.push_back (job);
+                }
+            }
+
+            void process (Job& job)
+            {
+                try
+                {
+                    if (job.mType==Job::Type_Mesh)
+                    {
+                        job.mMesh.reset (new Nif::NIFFile (job.mName, job.mStream));
+
+                        for (size_t i=0; i<job.mMesh->numRecords(); ++i)
+                        {
+                            const Nif::Record *record = job.mMesh->getRecord (i);
+
+                            if (record && record->recType==Nif::RC_NiSourceTexture)
+                            {
+                                const Nif::NiSourceTexture *texture =
+                                    static_cast<const Nif::NiSourceTexture *> (record);
+
+                                if (texture->external)
+                                    job.mTextures.push_back (texture->filename);
+                            }
+                        }
+                    }
+                    else
+                        job.mImage.load (job.mStream, job.mExtension);
+                }
+                catch (const std::exception& e)
+                {
+                    job.mError = e.what();
+                }
+
+                job.mStream.setNull();
+            }
+
+        public:
+
+            WorkerThreads (int threads)
+            {
+                for (int i=0; i<threads; ++i)
+                    mThreads.create_thread (boost::bind (&WorkerThreads::run, this));
+            }
+
+            ~WorkerThreads()
+            {
+                mThreads.interrupt_all();
+                mThreads.join_all();
+            }
+
+            void add (const JobPtr& job)
+            {
+                boost::lock_guard<boost::mutex> lock (mMutex);
+                mQueue.push_back (job);
+                mCondition.notify_one();
+            }
+
+            /// Move the jobs that finished since the last call to \a jobs.
+            void collect (std::vector<JobPtr>& jobs)
+            {
+                boost::lock_guard<boost::mutex> lock (mMutex);
+                jobs.swap (mFinished);
+            }
+
+            void removeAll()
+            {
+                boost::lock_guard<boost::mutex> lock (mMutex);
+                mQueue.clear();
+                mFinished.clear();
+            }
+    };
+
+    CellPreloader::CellPreloader (PhysicsSystem& physics, int threads)
+    : mPhysics (physics), mWorkers (new WorkerThreads (std::max (threads, 1)))
+    {}
+
+    CellPreloader::~CellPreloader()
+    {
+        delete mWorkers;
+    }
+
+    void CellPreloader::preloadExterior (int x, int y)
+    {
+        std::pair<int, int> index (x, y);
+
+        if (mRequestedExteriors.insert (index).second)
+            mPendingExteriors.push_back (index);
+    }
+
+    void CellPreloader::preloadInterior (const std::string& name)
+    {
+        std::string lowerName = Misc::StringUtils::lowerCase (name);
+
+        if (mRequestedInteriors.insert (lowerName).second)
+            mPendingInteriors.push_back (lowerName);
+    }
+
+    void CellPreloader::update()
+    {
+        Misc::ProfileZone zone ("CellPreloader::update");
+
+        MWBase::World *world = MWBase::Environment::get().getWorld();
+
+        // load references of at most one cell per frame
+        try
+        {
+            if (!mPendingInteriors.empty())
+            {
+                std::string name = mPendingInteriors.front();
+                mPendingInteriors.pop_front();
+                loadCell (world->getInterior (name));
+            }
+            else if (!mPendingExteriors.empty())
+            {
+                std::pair<int, int> index = mPendingExteriors.front();
+                mPendingExteriors.pop_front();
+                loadCell (world->getExterior (index.first, index.second));
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "failed to preload cell: " << e.what() << std::endl;
+        }
+
+        std::vector<JobPtr> finished;
+        mWorkers->collect (finished);
+
+        for (std::vector<JobPtr>::const_iterator iter (finished.begin()); iter!=finished.end(); ++iter)
+            finishJob (*iter);
+
+        for (unsigned int i=0; i<sTexturesPerFrame && !mPendingTextures.empty(); ++i)
+        {
+            JobPtr job = mPendingTextures.front();
+            mPendingTextures.pop_front();
+
+            try
+            {
+                Ogre::TextureManager& manager = Ogre::TextureManager::getSingleton();
+
+                if (manager.getByName (job->mName).isNull())
+                    manager.loadImage (job->mName,
+                        Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, job->mImage);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "failed to preload texture " << job->mName << ": " << e.what() << std::endl;
+            }
+        }
+
+        for (unsigned int i=0; i<sShapesPerFrame && !mPendingShapes.empty(); )
+        {
+            std::pair<std::string, float> shape = mPendingShapes.front();
+
+            // the shape loader would otherwise parse the mesh itself
+            if (mParsingMeshes.find (shape.first)!=mParsingMeshes.end())
+                break;
+
+            mPendingShapes.pop_front();
+
+            if (!Nif::Cache::getInstance().isLoaded (shape.first))
+                continue;
+
+            try
+            {
+                mPhysics.preloadShape (shape.first, shape.second);
+            }
+            catch (const std::exception& e)
+            {
+                std::cerr << "failed to preload collision shape for " << shape.first << ": " << e.what() << std::endl;
+            }
+
+            ++i;
+        }
+    }
+
+    void CellPreloader::clear()
+    {
+        mWorkers->removeAll();
+
+        mRequestedExteriors.clear();
+        mRequestedInteriors.clear();
+        mPendingExteriors.clear();
+        mPendingInteriors.clear();
+        mRequestedResources.clear();
+        mParsingMeshes.clear();
+        mRequestedShapes.clear();
+        mPendingShapes.clear();
+        mPendingTextures.clear();
+    }
+
+    void CellPreloader::loadCell (CellStore *cell)
+    {
+        if (cell->isExterior())
+        {
+            // terrain data is read from the content files, so it can't be loaded in the background
+            MWRender::TerrainStorage::getLoadedLand (cell->getCell()->getGridX(), cell->getCell()->getGridY());
+        }
+
+        // the player may never enter the cell, so it must not end up in the saved game
+        ListModelsFunctor functor;
+        cell->forEachUnchanged (functor);
+
+        for (std::vector<std::pair<std::string, float> >::const_iterator iter (functor.mModels.begin());
+            iter!=functor.mModels.end(); ++iter)
+        {
+            requestMesh (iter->first);
+
+            if (iter->second>0 && mRequestedShapes.insert (*iter).second)
+                mPendingShapes.push_back (*iter);
+        }
+    }
+
+    void CellPreloader::requestMesh (const std::string& mesh)
+    {
+        if (!mRequestedResources.insert (mesh).second || Nif::Cache::getInstance().isLoaded (mesh))
+            return;
+
+        JobPtr job (new Job);
+        job->mType = Job::Type_Mesh;
+        job->mName = mesh;
+
+        try
+        {
+            // The resource system is not thread safe, but reading from an opened stream is.
+            job->mStream = Ogre::ResourceGroupManager::getSingleton().openResource (mesh);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "failed to preload mesh " << mesh << ": " << e.what() << std::endl;
+            return;
+        }
+
+        mParsingMeshes.insert (mesh);
+        mWorkers->add (job);
+    }
+
+    void CellPreloader::requestTexture (const std::string& texture)
+    {
+        std::string name = Misc::ResourceHelpers::correctTexturePath (texture);
+
+        if (!mRequestedResources.insert (name).second ||
+            !Ogre::TextureManager::getSingleton().getByName (name).isNull())
+            return;
+
+        std::string::size_type extension = name.rfind ('.');
+
+        if (extension==std::string::npos)
+            return;
+
+        JobPtr job (new Job);
+        job->mType = Job::Type_Texture;
+        job->mName = name;
+        job->mExtension = name.substr (extension+1);
+
+        try
+        {
+            job->mStream = Ogre::ResourceGroupManager::getSingleton().openResource (name);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "failed to preload texture " << name << ": " << e.what() << std::endl;
+            return;
+        }
+
+        mWorkers->add (job);
+    }
+
+    void CellPreloader::finishJob (const JobPtr& job)
+    {
+        if (job->mType==Job::Type_Mesh)
+            mParsingMeshes.erase (job->mName);
+
+        if (!job->mError.empty())
+        {
+            std::cerr << "failed to preload " << job->mName << ": " << job->mError << std::endl;
+            return;
+        }
+
+        if (job->mType==Job::Type_Mesh)
+        {
+            Nif::Cache::getInstance().insert (job->mName, job->mMesh);
+
+            for (std::vector<std::string>::const_iterator iter (job->mTextures.begin());
+                iter!=job->mTextures.end(); ++iter)
+                requestTexture (*iter);
+        }
+        else
+            mPendingTextures.push_back (job);
+    }
+}
@@ -0,0 +1,82 @@
+#ifndef GAME_MWWORLD_CELLPRELOADER_H
+#define GAME_MWWORLD_CELLPRELOADER_H
+
+#include <deque>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace MWWorld
+{
+    class CellStore;
+    class PhysicsSystem;
+
+    /// \brief Loads the content of cells before the player enters them
+    ///
+    /// The references of a requested cell are loaded on the main thread, one cell per frame.
+    /// Its meshes are then parsed and its textures decoded by worker threads. The results are
+    /// handed to the NIF cache, the texture manager and the collision shape manager on the main
+    /// thread, a few per frame, so that entering the cell later only needs to attach objects to
+    /// the scene.
+    class CellPreloader
+    {
+        public:
+
+            struct Job;
+            typedef boost::shared_ptr<Job> JobPtr;
+
+        private:
+
+            class WorkerThreads;
+
+            PhysicsSystem& mPhysics;
+            WorkerThreads *mWorkers;
+
+            std::set<std::pair<int, int> > mRequestedExteriors;
+            std::set<std::string> mRequestedInteriors;
+            std::deque<std::pair<int, int> > mPendingExteriors;
+            std::deque<std::string> mPendingInteriors;
+
+            std::set<std::string> mRequestedResources; // meshes and textures
+            std::set<std::string> mParsingMeshes;
+            std::set<std::pair<std::string, float> > mRequestedShapes;
+            std::deque<std::pair<std::string, float> > mPendingShapes;
+            std::deque<JobPtr> mPendingTextures;
+
+            CellPreloader (const CellPreloader&);
+            CellPreloader& operator= (const CellPreloader&);
+
+            void loadCell (CellStore *cell);
+
+            void requestMesh (const std::string& mesh);
+
+            void requestTexture (const std::string& texture);
+
+            void finishJob (const JobPtr& job);
+
+        public:
+
+            CellPreloader (PhysicsSystem& physics, int threads);
+
+            ~CellPreloader();
+
+            void preloadExterior (int x, int y);
+            ///< Queue an exterior cell for preloading. Requests for cells that were already
+            /// requested are ignored.
+
+            void preloadInterior (const std::string& name);
+            ///< Queue an interior cell for preloading. Requests for cells that were already
+            /// requested are ignored.
+
+            void update();
+            ///< Continue preloading; must be called once per frame.
+
+            void clear();
+            ///< Drop pending work and forget previous requests.
+    };
+}
+
+#endif
@@ -129,6 +129,14 @@ namespace MWWorld
             {
                 mHasState = true;
 
+                return forEachUnchanged (functor);
+            }
+
+            /// Like forEach, but the cell is not marked as having state that needs to be saved.
+            /// Only for functors that do not change the references.
+            template<class Functor>
+            bool forEachUnchanged (Functor& functor)
+            {
                 return
                     forEachImp (functor, mActivators) &&
                     forEachImp (functor, mPotions) &&
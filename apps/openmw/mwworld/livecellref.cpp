@@ -10,12 +10,33 @@
 #include "ptr.hpp"
 #include "class.hpp"
 #include "esmstore.hpp"
+#include "objecthandle.hpp"
 
 MWWorld::LiveCellRefBase::LiveCellRefBase(std::string type, const ESM::CellRef &cref)
-  : mClass(&Class::get(type)), mRef(cref), mData(cref)
+  : mClass(&Class::get(type)), mRef(cref), mData(cref), mHandleIndex(0)
 {
 }
 
+MWWorld::LiveCellRefBase::LiveCellRefBase (const LiveCellRefBase& ref)
+  : mClass(ref.mClass), mRef(ref.mRef), mData(ref.mData), mHandleIndex(0)
+{
+}
+
+MWWorld::LiveCellRefBase& MWWorld::LiveCellRefBase::operator= (const LiveCellRefBase& ref)
+{
+    // keep the handle slot; handles refer to this object, not to its content
+    mClass = ref.mClass;
+    mRef = ref.mRef;
+    mData = ref.mData;
+    return *this;
+}
+
+MWWorld::LiveCellRefBase::~LiveCellRefBase()
+{
+    if (mHandleIndex)
+        ObjectHandleTable::get().release (*this);
+}
+
 void MWWorld::LiveCellRefBase::loadImp (const ESM::ObjectState& state)
 {
     mRef = state.mRef;
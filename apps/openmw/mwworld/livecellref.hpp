@@ -31,9 +31,17 @@ namespace MWWorld
         /** runtime-data */
         RefData mData;
 
+        /// Slot in the ObjectHandleTable (0: no handle has been requested). Copies of a
+        /// reference do not share the slot of the original.
+        unsigned int mHandleIndex;
+
         LiveCellRefBase(std::string type, const ESM::CellRef &cref=ESM::CellRef());
-        /* Need this for the class to be recognized as polymorphic */
-        virtual ~LiveCellRefBase() { }
+
+        LiveCellRefBase (const LiveCellRefBase& ref);
+
+        LiveCellRefBase& operator= (const LiveCellRefBase& ref);
+
+        virtual ~LiveCellRefBase();
 
         virtual void load (const ESM::ObjectState& state) = 0;
         ///< Load state into a LiveCellRef, that has already been initialised with base and class.
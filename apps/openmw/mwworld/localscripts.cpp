@@ -1,6 +1,7 @@
 #include "localscripts.hpp"
 
 #include <iostream>
+#include <cassert>
 
 #include "esmstore.hpp"
 #include "cellstore.hpp"
@@ -8,6 +9,9 @@
 #include "class.hpp"
 #include "containerstore.hpp"
 
+#include "../mwbase/environment.hpp"
+#include "../mwbase/scriptmanager.hpp"
+
 
 namespace
 {
@@ -53,42 +57,111 @@ namespace
     }
 }
 
-MWWorld::LocalScripts::LocalScripts (const MWWorld::ESMStore& store) : mStore (store) {}
+MWWorld::LocalScripts::Script::Script (const std::string& name, const Ptr& ptr, double time)
+: mName (name), mHandle (-1), mPtr (ptr), mLastRun (time), mSecondsPassed (0)
+{}
 
-void MWWorld::LocalScripts::setIgnore (const Ptr& ptr)
-{
-    mIgnore = ptr;
-}
+MWWorld::LocalScripts::LocalScripts (const MWWorld::ESMStore& store)
+: mIter (0), mPassSize (0), mVisited (0), mHasRemoved (false), mTime (0), mStore (store)
+{}
 
-void MWWorld::LocalScripts::startIteration()
+void MWWorld::LocalScripts::skip()
 {
-    mIter = mScripts.begin();
+    while (mVisited<mPassSize)
+    {
+        Script& script = mScripts[mIter];
+
+        if (!script.mPtr.isEmpty() && (mIgnore.isEmpty() || script.mPtr!=mIgnore))
+        {
+            if (script.mHandle==-1)
+            {
+                MWBase::ScriptManager *scriptManager = MWBase::Environment::get().getScriptManager();
+
+                script.mHandle = scriptManager->getHandle (script.mName);
+
+                if (scriptManager->isActivationOnly (script.mHandle))
+                {
+                    // World::activate runs the script directly, no need to poll it
+                    script.mPtr = Ptr();
+                    mHasRemoved = true;
+                }
+            }
+
+            if (!script.mPtr.isEmpty())
+                return;
+        }
+
+        ++mVisited;
+
+        if (++mIter>=mPassSize)
+            mIter = 0;
+    }
 }
 
-bool MWWorld::LocalScripts::isFinished() const
+void MWWorld::LocalScripts::compact()
 {
-    if (mIter==mScripts.end())
-        return true;
+    std::size_t target = 0;
+    std::size_t iter = 0;
 
-    if (!mIgnore.isEmpty() && mIter->second==mIgnore)
+    for (std::size_t i=0; i<mScripts.size(); ++i)
     {
-        std::list<std::pair<std::string, Ptr> >::iterator iter = mIter;
-        return ++iter==mScripts.end();
+        if (i==mIter)
+            iter = target;
+
+        if (!mScripts[i].mPtr.isEmpty())
+        {
+            if (target!=i)
+                mScripts[target] = mScripts[i];
+
+            ++target;
+        }
     }
 
-    return false;
+    mScripts.erase (mScripts.begin()+target, mScripts.end());
+    mIter = iter;
+    mHasRemoved = false;
 }
 
-std::pair<std::string, MWWorld::Ptr> MWWorld::LocalScripts::getNext()
+void MWWorld::LocalScripts::setIgnore (const Ptr& ptr)
+{
+    mIgnore = ptr;
+}
+
+void MWWorld::LocalScripts::startIteration (float duration)
+{
+    mTime += duration;
+
+    if (mHasRemoved)
+        compact();
+
+    if (mIter>=mScripts.size())
+        mIter = 0;
+
+    mPassSize = mScripts.size();
+    mVisited = 0;
+}
+
+bool MWWorld::LocalScripts::isFinished()
+{
+    skip();
+    return mVisited>=mPassSize;
+}
+
+const MWWorld::LocalScripts::Script& MWWorld::LocalScripts::getNext()
 {
     assert (!isFinished());
 
-    std::list<std::pair<std::string, Ptr> >::iterator iter = mIter++;
+    Script& script = mScripts[mIter];
 
-    if (mIgnore.isEmpty() || iter->second!=mIgnore)
-        return *iter;
+    script.mSecondsPassed = static_cast<float> (mTime-script.mLastRun);
+    script.mLastRun = mTime;
 
-    return getNext();
+    ++mVisited;
+
+    if (++mIter>=mPassSize)
+        mIter = 0;
+
+    return script;
 }
 
 void MWWorld::LocalScripts::add (const std::string& scriptName, const Ptr& ptr)
@@ -99,7 +172,7 @@ void MWWorld::LocalScripts::add (const std::string& scriptName, const Ptr& ptr)
         {
             ptr.getRefData().setLocals (*script);
 
-            mScripts.push_back (std::make_pair (scriptName, ptr));
+            mScripts.push_back (Script (scriptName, ptr, mTime));
         }
         catch (const std::exception& exception)
         {
@@ -137,50 +210,40 @@ void MWWorld::LocalScripts::addCell (CellStore *cell)
 void MWWorld::LocalScripts::clear()
 {
     mScripts.clear();
+    mIter = 0;
+    mPassSize = 0;
+    mVisited = 0;
+    mHasRemoved = false;
 }
 
 void MWWorld::LocalScripts::clearCell (CellStore *cell)
 {
-    std::list<std::pair<std::string, Ptr> >::iterator iter = mScripts.begin();
-
-    while (iter!=mScripts.end())
-    {
-        if (iter->second.mCell==cell)
+    for (std::vector<Script>::iterator iter (mScripts.begin()); iter!=mScripts.end(); ++iter)
+        if (!iter->mPtr.isEmpty() && iter->mPtr.mCell==cell)
         {
-            if (iter==mIter)
-               ++mIter;
-
-            mScripts.erase (iter++);
+            iter->mPtr = Ptr();
+            mHasRemoved = true;
         }
-        else
-            ++iter;
-    }
 }
 
 void MWWorld::LocalScripts::remove (RefData *ref)
 {
-    for (std::list<std::pair<std::string, Ptr> >::iterator iter = mScripts.begin();
-        iter!=mScripts.end(); ++iter)
-        if (&(iter->second.getRefData()) == ref)
+    for (std::vector<Script>::iterator iter (mScripts.begin()); iter!=mScripts.end(); ++iter)
+        if (!iter->mPtr.isEmpty() && &(iter->mPtr.getRefData()) == ref)
         {
-            if (iter==mIter)
-                ++mIter;
-
-            mScripts.erase (iter);
-            break;
+            iter->mPtr = Ptr();
+            mHasRemoved = true;
+            return;
         }
 }
 
 void MWWorld::LocalScripts::remove (const Ptr& ptr)
 {
-    for (std::list<std::pair<std::string, Ptr> >::iterator iter = mScripts.begin();
-        iter!=mScripts.end(); ++iter)
-        if (iter->second==ptr)
+    for (std::vector<Script>::iterator iter (mScripts.begin()); iter!=mScripts.end(); ++iter)
+        if (!iter->mPtr.isEmpty() && iter->mPtr==ptr)
         {
-            if (iter==mIter)
-                ++mIter;
-
-            mScripts.erase (iter);
-            break;
+            iter->mPtr = Ptr();
+            mHasRemoved = true;
+            return;
         }
 }
@@ -1,7 +1,7 @@
 #ifndef GAME_MWWORLD_LOCALSCRIPTS_H
 #define GAME_MWWORLD_LOCALSCRIPTS_H
 
-#include <list>
+#include <vector>
 #include <string>
 
 #include "ptr.hpp"
@@ -13,13 +13,44 @@ namespace MWWorld
     class RefData;
 
     /// \brief List of active local scripts
+    ///
+    /// Scripts are visited in passes. A pass may be interrupted (e.g. when the time budget for
+    /// local scripts is used up), in which case the next pass continues with the first script
+    /// that has not been visited, so every script gets its turn. The budget is checked between
+    /// scripts only; a script always runs to its end, since the interpreter cannot suspend it.
     class LocalScripts
     {
-            std::list<std::pair<std::string, Ptr> > mScripts;
-            std::list<std::pair<std::string, Ptr> >::iterator mIter;
+        public:
+
+            struct Script
+            {
+                std::string mName;
+                int mHandle; ///< -1: not resolved yet
+                Ptr mPtr; ///< empty: script has been removed
+                double mLastRun;
+                float mSecondsPassed; ///< time between the last two runs (set by getNext)
+
+                Script (const std::string& name, const Ptr& ptr, double time);
+            };
+
+        private:
+
+            std::vector<Script> mScripts;
+            std::size_t mIter;
+            std::size_t mPassSize;
+            std::size_t mVisited;
+            bool mHasRemoved;
+            double mTime;
             MWWorld::Ptr mIgnore;
             const MWWorld::ESMStore& mStore;
 
+            void skip();
+            ///< Advance to the next script that needs to be run in this pass (scripts that
+            /// have been removed since the last call are skipped too).
+
+            void compact();
+            ///< Erase removed scripts (must not be called during a pass).
+
         public:
 
             LocalScripts (const MWWorld::ESMStore& store);
@@ -28,14 +59,19 @@ namespace MWWorld
             ///< Mark a single reference for ignoring during iteration over local scripts (will revoke
             /// previous ignores).
 
-            void startIteration();
-            ///< Set the iterator to the begin of the script list.
+            void startIteration (float duration);
+            ///< Start a new pass, continuing after the last script visited in the previous pass.
+            ///
+            /// \param duration Time since the last pass has been started.
 
-            bool isFinished() const;
+            bool isFinished();
             ///< Is iteration finished?
 
-            std::pair<std::string, Ptr> getNext();
+            const Script& getNext();
             ///< Get next local script (must not be called if isFinished())
+            ///
+            /// The reference is invalidated by adding a script, so its contents must be copied
+            /// before the script is run.
 
             void add (const std::string& scriptName, const Ptr& ptr);
             ///< Add script to collection of active local scripts.
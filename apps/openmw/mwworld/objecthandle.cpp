@@ -0,0 +1,113 @@
+#include "objecthandle.hpp"
+
+#include "livecellref.hpp"
+#include "ptr.hpp"
+
+namespace MWWorld
+{
+    ObjectHandleTable::ObjectHandleTable()
+    {
+        // slot 0 marks an empty handle
+        Slot slot;
+        slot.mRef = 0;
+        slot.mCell = 0;
+        slot.mContainerStore = 0;
+        slot.mGeneration = 0;
+        mSlots.push_back (slot);
+    }
+
+    ObjectHandleTable& ObjectHandleTable::get()
+    {
+        static ObjectHandleTable sTable;
+        return sTable;
+    }
+
+    ObjectHandle ObjectHandleTable::getHandle (const Ptr& ptr)
+    {
+        ObjectHandle handle;
+
+        if (ptr.isEmpty())
+            return handle;
+
+        LiveCellRefBase& ref = *ptr.getBase();
+
+        if (ref.mHandleIndex==0)
+        {
+            if (mFreeSlots.empty())
+            {
+                Slot slot;
+                slot.mGeneration = 0;
+                mSlots.push_back (slot);
+                ref.mHandleIndex = mSlots.size()-1;
+            }
+            else
+            {
+                ref.mHandleIndex = mFreeSlots.back();
+                mFreeSlots.pop_back();
+            }
+
+            Slot& slot = mSlots[ref.mHandleIndex];
+            slot.mRef = &ref;
+            slot.mCell = ptr.mCell;
+            slot.mContainerStore = ptr.getContainerStore();
+        }
+
+        handle.mIndex = ref.mHandleIndex;
+        handle.mGeneration = mSlots[ref.mHandleIndex].mGeneration;
+        return handle;
+    }
+
+    Ptr ObjectHandleTable::getPtr (const ObjectHandle& handle) const
+    {
+        if (handle.mIndex==0 || handle.mIndex>=mSlots.size())
+            return Ptr();
+
+        const Slot& slot = mSlots[handle.mIndex];
+
+        if (slot.mGeneration!=handle.mGeneration || !slot.mRef || slot.mRef->mData.isDeleted())
+            return Ptr();
+
+        Ptr ptr (slot.mRef, slot.mCell);
+
+        if (slot.mContainerStore)
+            ptr.setContainerStore (slot.mContainerStore);
+
+        return ptr;
+    }
+
+    void ObjectHandleTable::transfer (LiveCellRefBase& from, const Ptr& to)
+    {
+        if (from.mHandleIndex==0)
+            return;
+
+        LiveCellRefBase& ref = *to.getBase();
+
+        if (&ref!=&from)
+        {
+            // the copy takes over the slot of the original
+            release (ref);
+            ref.mHandleIndex = from.mHandleIndex;
+            from.mHandleIndex = 0;
+        }
+
+        Slot& slot = mSlots[ref.mHandleIndex];
+        slot.mRef = &ref;
+        slot.mCell = to.mCell;
+        slot.mContainerStore = to.getContainerStore();
+    }
+
+    void ObjectHandleTable::release (LiveCellRefBase& ref)
+    {
+        if (ref.mHandleIndex==0)
+            return;
+
+        Slot& slot = mSlots[ref.mHandleIndex];
+        slot.mRef = 0;
+        slot.mCell = 0;
+        slot.mContainerStore = 0;
+        ++slot.mGeneration;
+
+        mFreeSlots.push_back (ref.mHandleIndex);
+        ref.mHandleIndex = 0;
+    }
+}
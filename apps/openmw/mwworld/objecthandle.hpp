@@ -0,0 +1,90 @@
+#ifndef GAME_MWWORLD_OBJECTHANDLE_H
+#define GAME_MWWORLD_OBJECTHANDLE_H
+
+#include <vector>
+
+namespace MWWorld
+{
+    class CellStore;
+    class ContainerStore;
+    class Ptr;
+    struct LiveCellRefBase;
+
+    /// \brief Weak reference to an object
+    ///
+    /// Unlike a Ptr a handle can be kept across frames. It follows the object when the object is
+    /// moved to another cell, and can be resolved in constant time. Once the object is destroyed
+    /// the handle resolves to an empty Ptr, even if its slot has been reused for another object.
+    struct ObjectHandle
+    {
+        unsigned int mIndex; // 0: empty handle
+        unsigned int mGeneration;
+
+        ObjectHandle() : mIndex (0), mGeneration (0) {}
+
+        bool isEmpty() const
+        {
+            return mIndex==0;
+        }
+    };
+
+    inline bool operator== (const ObjectHandle& left, const ObjectHandle& right)
+    {
+        return left.mIndex==right.mIndex && left.mGeneration==right.mGeneration;
+    }
+
+    inline bool operator!= (const ObjectHandle& left, const ObjectHandle& right)
+    {
+        return !(left==right);
+    }
+
+    inline bool operator< (const ObjectHandle& left, const ObjectHandle& right)
+    {
+        if (left.mIndex!=right.mIndex)
+            return left.mIndex<right.mIndex;
+
+        return left.mGeneration<right.mGeneration;
+    }
+
+    /// \brief Slots of the objects handles have been requested for
+    ///
+    /// A slot is assigned to an object the first time a handle to it is requested, and freed
+    /// when the object is destroyed.
+    class ObjectHandleTable
+    {
+            struct Slot
+            {
+                LiveCellRefBase *mRef; // 0: free slot
+                CellStore *mCell;
+                ContainerStore *mContainerStore;
+                unsigned int mGeneration;
+            };
+
+            std::vector<Slot> mSlots;
+            std::vector<unsigned int> mFreeSlots;
+
+            ObjectHandleTable();
+
+            ObjectHandleTable (const ObjectHandleTable&);
+            ObjectHandleTable& operator= (const ObjectHandleTable&);
+
+        public:
+
+            static ObjectHandleTable& get();
+
+            ObjectHandle getHandle (const Ptr& ptr);
+            ///< \return Empty handle, if \a ptr is empty.
+
+            Ptr getPtr (const ObjectHandle& handle) const;
+            ///< \return Empty Ptr, if the object of \a handle has been destroyed or deleted.
+
+            void transfer (LiveCellRefBase& from, const Ptr& to);
+            ///< Let handles to \a from refer to \a to from now on. Must be called when an object
+            /// is copied to another cell, or the cell of the player changes.
+
+            void release (LiveCellRefBase& ref);
+            ///< Invalidate all handles to \a ref.
+    };
+}
+
+#endif
@@ -19,6 +19,7 @@
 #include <components/nifbullet/bulletnifloader.hpp>
 #include <components/nifogre/skeleton.hpp>
 #include <components/misc/resourcehelpers.hpp>
+#include <components/misc/profiler.hpp>
 
 #include <components/esm/loadgmst.hpp>
 
@@ -682,6 +683,11 @@ namespace MWWorld
             mesh, node->getName(), ptr.getCellRef().getScale(), node->getPosition(), node->getOrientation(), 0, 0, true, placeable);
     }
 
+    void PhysicsSystem::preloadShape (const std::string& mesh, float scale)
+    {
+        mEngine->loadShape(mesh, scale);
+    }
+
     void PhysicsSystem::addActor (const Ptr& ptr, const std::string& mesh)
     {
         Ogre::SceneNode* node = ptr.getRefData().getBaseNode();
@@ -848,6 +854,8 @@ namespace MWWorld
 
     const PtrVelocityList& PhysicsSystem::applyQueuedMovement(float dt)
     {
+        Misc::ProfileZone zone ("PhysicsSystem::applyQueuedMovement");
+
         mMovementResults.clear();
 
         mTimeAccum += dt;
@@ -42,6 +42,9 @@ namespace MWWorld
 
             void addActor (const MWWorld::Ptr& ptr, const std::string& mesh);
 
+            void preloadShape (const std::string& mesh, float scale);
+            ///< Create the collision shapes for objects with \a mesh at \a scale ahead of time.
+
             void addHeightField (float* heights,
                 int x, int y, float yoffset,
                 float triSize, float sqrtVerts);
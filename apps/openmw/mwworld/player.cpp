@@ -26,6 +26,7 @@
 #include "ptr.hpp"
 #include "inventorystore.hpp"
 #include "cellstore.hpp"
+#include "objecthandle.hpp"
 
 namespace MWWorld
 {
@@ -57,6 +58,7 @@ namespace MWWorld
     void Player::setCell (MWWorld::CellStore *cellStore)
     {
         mCellStore = cellStore;
+        ObjectHandleTable::get().transfer (mPlayer, getPlayer());
     }
 
     MWWorld::Ptr Player::getPlayer()
@@ -188,6 +190,7 @@ namespace MWWorld
     void Player::clear()
     {
         mCellStore = 0;
+        ObjectHandleTable::get().release (mPlayer);
         mSign.clear();
         mMarkedCell = 0;
         mAutoMove = false;
@@ -260,6 +263,8 @@ namespace MWWorld
                 mCellStore = world.getExterior(0,0);
             }
 
+            ObjectHandleTable::get().transfer (mPlayer, getPlayer());
+
             if (!player.mBirthsign.empty())
             {
                 const ESM::BirthSign* sign = world.getStore().get<ESM::BirthSign>().search (player.mBirthsign);
@@ -1,11 +1,15 @@
 #include "projectilemanager.hpp"
 
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
 #include <OgreSceneManager.h>
 #include <OgreSceneNode.h>
 
 #include <libs/openengine/bullet/physic.hpp>
 
 #include <components/esm/projectilestate.hpp>
+#include <components/settings/settings.hpp>
 
 #include "../mwworld/manualref.hpp"
 #include "../mwworld/class.hpp"
@@ -26,14 +30,105 @@
 
 #include "../mwsound/sound.hpp"
 
+namespace
+{
+    // Projectiles are tested as small spheres against everything that can be hit by a ray
+    const float sProjectileRadius = 1.f;
+    const int sFilterGroup = OEngine::Physic::CollisionType_Projectile;
+    const int sFilterMask = OEngine::Physic::CollisionType_Raycasting|OEngine::Physic::CollisionType_Actor|
+        OEngine::Physic::CollisionType_HeightMap;
+}
+
 namespace MWWorld
 {
+    //
+    // Runs the collision tests of one update in the background
+    //
+    class ProjectileManager::CollisionTestThread
+    {
+            const OEngine::Physic::PhysicEngine& mPhysEngine;
+            const std::vector<OEngine::Physic::SphereSweep>* mSweeps;
+            std::vector<OEngine::Physic::SweepHit>* mHits;
+            bool mPending;
+            bool mQuit;
+            boost::mutex mMutex;
+            boost::condition_variable mCondition;
+            boost::thread mThread;
+
+            CollisionTestThread (const CollisionTestThread&);
+            CollisionTestThread& operator= (const CollisionTestThread&);
+
+            void run()
+            {
+                boost::unique_lock<boost::mutex> lock (mMutex);
+
+                while (true)
+                {
+                    while (!mPending && !mQuit)
+                        mCondition.wait (lock);
+
+                    if (mQuit)
+                        return;
+
+                    lock.unlock();
+                    mPhysEngine.sweepSpheres (*mSweeps, *mHits, sFilterGroup, sFilterMask);
+                    lock.lock();
+
+                    mPending = false;
+                    mCondition.notify_all();
+                }
+            }
+
+        public:
+
+            CollisionTestThread (const OEngine::Physic::PhysicEngine& engine)
+            : mPhysEngine (engine), mSweeps (0), mHits (0), mPending (false), mQuit (false),
+              mThread (boost::bind (&CollisionTestThread::run, this))
+            {}
+
+            ~CollisionTestThread()
+            {
+                {
+                    boost::lock_guard<boost::mutex> lock (mMutex);
+                    mQuit = true;
+                    mCondition.notify_all();
+                }
+
+                mThread.join();
+            }
+
+            void start (const std::vector<OEngine::Physic::SphereSweep>& sweeps,
+                std::vector<OEngine::Physic::SweepHit>& hits)
+            {
+                boost::lock_guard<boost::mutex> lock (mMutex);
+                mSweeps = &sweeps;
+                mHits = &hits;
+                mPending = true;
+                mCondition.notify_all();
+            }
+
+            void wait()
+            {
+                boost::unique_lock<boost::mutex> lock (mMutex);
+                while (mPending)
+                    mCondition.wait (lock);
+            }
+    };
 
     ProjectileManager::ProjectileManager(Ogre::SceneManager* sceneMgr, OEngine::Physic::PhysicEngine &engine)
         : mPhysEngine(engine)
         , mSceneMgr(sceneMgr)
+        , mTestThread(NULL)
+        , mNumProjectileSweeps(0)
+        , mUntestedSweeps(false)
     {
+        if (Settings::Manager::getBool("background projectile collisions", "Game"))
+            mTestThread = new CollisionTestThread(engine);
+    }
 
+    ProjectileManager::~ProjectileManager()
+    {
+        delete mTestThread;
     }
 
     void ProjectileManager::createModel(State &state, const std::string &model)
@@ -87,7 +182,7 @@ namespace MWWorld
         state.mSourceName = sourceName;
         state.mId = model;
         state.mSpellId = spellId;
-        state.mCasterHandle = caster.getRefData().getHandle();
+        state.mCaster = ObjectHandleTable::get().getHandle(caster);
         if (caster.getClass().isActor())
             state.mActorId = caster.getClass().getCreatureStats(caster).getActorId();
         else
@@ -136,17 +231,54 @@ namespace MWWorld
 
     void ProjectileManager::update(float dt)
     {
+        // Tests that ran in the background cover the movement of the previous update
+        if (mTestThread)
+        {
+            waitForCollisionTests();
+            applyHits();
+        }
+
+        mSweeps.clear();
         moveProjectiles(dt);
+        mNumProjectileSweeps = mSweeps.size();
         moveMagicBolts(dt);
+
+        if (mTestThread)
+            mUntestedSweeps = true;
+        else
+        {
+            mPhysEngine.sweepSpheres(mSweeps, mSweepHits, sFilterGroup, sFilterMask);
+            resolveHits();
+            applyHits();
+        }
+    }
+
+    void ProjectileManager::launchCollisionTests()
+    {
+        if (!mTestThread || !mUntestedSweeps)
+            return;
+
+        mUntestedSweeps = false;
+        mTestThread->start(mSweeps, mSweepHits);
+    }
+
+    void ProjectileManager::waitForCollisionTests()
+    {
+        if (!mTestThread)
+            return;
+
+        mTestThread->wait();
+        resolveHits();
     }
 
     void ProjectileManager::moveMagicBolts(float duration)
     {
-        for (std::vector<MagicBoltState>::iterator it = mMagicBolts.begin(); it != mMagicBolts.end();)
+        static float fTargetSpellMaxSpeed = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
+                    .find("fTargetSpellMaxSpeed")->getFloat();
+
+        for (std::vector<MagicBoltState>::iterator it = mMagicBolts.begin(); it != mMagicBolts.end(); ++it)
         {
             Ogre::Quaternion orient = it->mNode->getOrientation();
-            static float fTargetSpellMaxSpeed = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                        .find("fTargetSpellMaxSpeed")->getFloat();
             float speed = fTargetSpellMaxSpeed * it->mSpeed;
 
             Ogre::Vector3 direction = orient.yAxis();
@@ -161,69 +293,17 @@ namespace MWWorld
 
             update(it->mObject, duration);
 
-            // Check for impact
-            // TODO: use a proper btRigidBody / btGhostObject?
-            btVector3 from(pos.x, pos.y, pos.z);
-            btVector3 to(newPos.x, newPos.y, newPos.z);
-
-            std::vector<std::pair<float, std::string> > collisions = mPhysEngine.rayTest2(from, to, OEngine::Physic::CollisionType_Projectile);
-            bool hit=false;
-
-            for (std::vector<std::pair<float, std::string> >::iterator cIt = collisions.begin(); cIt != collisions.end() && !hit; ++cIt)
-            {
-                MWWorld::Ptr obstacle = MWBase::Environment::get().getWorld()->searchPtrViaHandle(cIt->second);
-
-                MWWorld::Ptr caster = MWBase::Environment::get().getWorld()->searchPtrViaHandle(it->mCasterHandle);
-                if (caster.isEmpty())
-                    caster = MWBase::Environment::get().getWorld()->searchPtrViaActorId(it->mActorId);
-
-                if (!obstacle.isEmpty() && obstacle == caster)
-                    continue;
-
-                if (caster.isEmpty())
-                    caster = obstacle;
-
-                if (obstacle.isEmpty())
-                {
-                    // Terrain
-                }
-                else
-                {
-                    MWMechanics::CastSpell cast(caster, obstacle);
-                    cast.mHitPosition = pos;
-                    cast.mId = it->mSpellId;
-                    cast.mSourceName = it->mSourceName;
-                    cast.mStack = it->mStack;
-                    cast.inflict(obstacle, caster, it->mEffects, ESM::RT_Target, false, true);
-                }
-
-                hit = true;
-            }
-
-            // Explodes when hitting water
-            if (MWBase::Environment::get().getWorld()->isUnderwater(MWBase::Environment::get().getWorld()->getPlayerPtr().getCell(), newPos))
-                hit = true;
-
-            if (hit)
-            {
-                MWWorld::Ptr caster = MWBase::Environment::get().getWorld()->searchPtrViaActorId(it->mActorId);
-                MWBase::Environment::get().getWorld()->explodeSpell(pos, it->mEffects, caster, ESM::RT_Target, it->mSpellId, it->mSourceName);
-
-                MWBase::Environment::get().getSoundManager()->stopSound(it->mSound);
-
-                mSceneMgr->destroySceneNode(it->mNode);
-
-                it = mMagicBolts.erase(it);
-                continue;
-            }
-            else
-                ++it;
+            OEngine::Physic::SphereSweep sweep;
+            sweep.mFrom = btVector3(pos.x, pos.y, pos.z);
+            sweep.mTo = btVector3(newPos.x, newPos.y, newPos.z);
+            sweep.mRadius = sProjectileRadius;
+            mSweeps.push_back(sweep);
         }
     }
 
     void ProjectileManager::moveProjectiles(float duration)
     {
-        for (std::vector<ProjectileState>::iterator it = mProjectiles.begin(); it != mProjectiles.end();)
+        for (std::vector<ProjectileState>::iterator it = mProjectiles.begin(); it != mProjectiles.end(); ++it)
         {
             // gravity constant - must be way lower than the gravity affecting actors, since we're not
             // simulating aerodynamics at all
@@ -238,24 +318,58 @@ namespace MWWorld
 
             update(it->mObject, duration);
 
-            // Check for impact
-            // TODO: use a proper btRigidBody / btGhostObject?
-            btVector3 from(pos.x, pos.y, pos.z);
-            btVector3 to(newPos.x, newPos.y, newPos.z);
-            std::vector<std::pair<float, std::string> > collisions = mPhysEngine.rayTest2(from, to, OEngine::Physic::CollisionType_Projectile);
-            bool hit=false;
+            OEngine::Physic::SphereSweep sweep;
+            sweep.mFrom = btVector3(pos.x, pos.y, pos.z);
+            sweep.mTo = btVector3(newPos.x, newPos.y, newPos.z);
+            sweep.mRadius = sProjectileRadius;
+            mSweeps.push_back(sweep);
+        }
+    }
+
+    void ProjectileManager::resolveHits()
+    {
+        for (std::vector<OEngine::Physic::SweepHit>::const_iterator it = mSweepHits.begin(); it != mSweepHits.end(); ++it)
+        {
+            Hit hit;
+            hit.mSweep = it->mSweep;
+            hit.mFraction = it->mFraction;
+            hit.mHandle = it->mObject->mName;
+            mHits.push_back(hit);
+        }
+
+        mSweepHits.clear();
+    }
+
+    void ProjectileManager::applyHits()
+    {
+        MWBase::World* world = MWBase::Environment::get().getWorld();
+
+        // Hits are sorted by sweep and distance; each projectile stops at the first obstacle that is not its caster
+        std::vector<bool> stopped(mSweeps.size(), false);
 
-            for (std::vector<std::pair<float, std::string> >::iterator cIt = collisions.begin(); cIt != collisions.end() && !hit; ++cIt)
+        for (std::vector<Hit>::const_iterator hitIt = mHits.begin(); hitIt != mHits.end(); ++hitIt)
+        {
+            size_t index = hitIt->mSweep;
+            if (stopped[index])
+                continue;
+
+            Ogre::Vector3 pos(mSweeps[index].mFrom.x(), mSweeps[index].mFrom.y(), mSweeps[index].mFrom.z());
+            Ogre::Vector3 newPos(mSweeps[index].mTo.x(), mSweeps[index].mTo.y(), mSweeps[index].mTo.z());
+
+            MWWorld::Ptr obstacle = world->searchPtrViaHandle(hitIt->mHandle);
+
+            if (index < mNumProjectileSweeps)
             {
-                MWWorld::Ptr obstacle = MWBase::Environment::get().getWorld()->searchPtrViaHandle(cIt->second);
+                // Copied, handling the hit may launch other projectiles
+                ProjectileState projectile = mProjectiles[index];
 
-                MWWorld::Ptr caster = MWBase::Environment::get().getWorld()->searchPtrViaActorId(it->mActorId);
+                MWWorld::Ptr caster = world->searchPtrViaActorId(projectile.mActorId);
 
                 // Arrow intersects with player immediately after shooting :/
                 if (obstacle == caster)
                     continue;
 
-                MWWorld::ManualRef projectileRef(MWBase::Environment::get().getWorld()->getStore(), it->mId);
+                MWWorld::ManualRef projectileRef(world->getStore(), projectile.mId);
 
                 // Try to get a Ptr to the bow that was used. It might no longer exist.
                 MWWorld::Ptr bow = projectileRef.getPtr();
@@ -263,31 +377,102 @@ namespace MWWorld
                 {
                     MWWorld::InventoryStore& inv = caster.getClass().getInventoryStore(caster);
                     MWWorld::ContainerStoreIterator invIt = inv.getSlot(MWWorld::InventoryStore::Slot_CarriedRight);
-                    if (invIt != inv.end() && Misc::StringUtils::ciEqual(invIt->getCellRef().getRefId(), it->mBowId))
+                    if (invIt != inv.end() && Misc::StringUtils::ciEqual(invIt->getCellRef().getRefId(), projectile.mBowId))
                         bow = *invIt;
                 }
 
                 if (caster.isEmpty())
                     caster = obstacle;
 
-                MWMechanics::projectileHit(caster, obstacle, bow, projectileRef.getPtr(), pos + (newPos - pos) * cIt->first);
+                stopped[index] = true;
 
-                hit = true;
+                MWMechanics::projectileHit(caster, obstacle, bow, projectileRef.getPtr(), pos + (newPos - pos) * hitIt->mFraction);
             }
-            if (hit)
+            else
             {
-                mSceneMgr->destroySceneNode(it->mNode);
+                MagicBoltState bolt = mMagicBolts[index - mNumProjectileSweeps];
 
-                it = mProjectiles.erase(it);
-                continue;
+                MWWorld::Ptr caster = ObjectHandleTable::get().getPtr(bolt.mCaster);
+                if (caster.isEmpty())
+                    caster = world->searchPtrViaActorId(bolt.mActorId);
+
+                if (!obstacle.isEmpty() && obstacle == caster)
+                    continue;
+
+                if (caster.isEmpty())
+                    caster = obstacle;
+
+                stopped[index] = true;
+
+                if (obstacle.isEmpty())
+                {
+                    // Terrain
+                }
+                else
+                {
+                    MWMechanics::CastSpell cast(caster, obstacle);
+                    cast.mHitPosition = pos;
+                    cast.mId = bolt.mSpellId;
+                    cast.mSourceName = bolt.mSourceName;
+                    cast.mStack = bolt.mStack;
+                    cast.inflict(obstacle, caster, bolt.mEffects, ESM::RT_Target, false, true);
+                }
             }
-            else
-                ++it;
         }
+
+        // Magic bolts explode when hitting water
+        for (size_t index = mNumProjectileSweeps; index < mSweeps.size(); ++index)
+        {
+            Ogre::Vector3 newPos(mSweeps[index].mTo.x(), mSweeps[index].mTo.y(), mSweeps[index].mTo.z());
+            if (!stopped[index] && world->isUnderwater(world->getPlayerPtr().getCell(), newPos))
+                stopped[index] = true;
+        }
+
+        // Remove from the back, so the indices of the remaining projectiles stay valid
+        for (size_t index = mSweeps.size(); index-- > mNumProjectileSweeps; )
+        {
+            if (!stopped[index])
+                continue;
+
+            std::vector<MagicBoltState>::iterator it = mMagicBolts.begin() + (index - mNumProjectileSweeps);
+
+            Ogre::Vector3 pos(mSweeps[index].mFrom.x(), mSweeps[index].mFrom.y(), mSweeps[index].mFrom.z());
+            MWWorld::Ptr caster = world->searchPtrViaActorId(it->mActorId);
+            world->explodeSpell(pos, it->mEffects, caster, ESM::RT_Target, it->mSpellId, it->mSourceName);
+
+            MWBase::Environment::get().getSoundManager()->stopSound(it->mSound);
+
+            mSceneMgr->destroySceneNode(it->mNode);
+
+            mMagicBolts.erase(it);
+        }
+
+        for (size_t index = mNumProjectileSweeps; index-- > 0; )
+        {
+            if (!stopped[index])
+                continue;
+
+            std::vector<ProjectileState>::iterator it = mProjectiles.begin() + index;
+
+            mSceneMgr->destroySceneNode(it->mNode);
+
+            mProjectiles.erase(it);
+        }
+
+        mSweeps.clear();
+        mNumProjectileSweeps = 0;
+        mHits.clear();
     }
 
     void ProjectileManager::clear()
     {
+        // The sweeps refer to projectiles by index
+        waitForCollisionTests();
+        mSweeps.clear();
+        mNumProjectileSweeps = 0;
+        mHits.clear();
+        mUntestedSweeps = false;
+
         for (std::vector<ProjectileState>::iterator it = mProjectiles.begin(); it != mProjectiles.end(); ++it)
         {
             mSceneMgr->destroySceneNode(it->mNode);
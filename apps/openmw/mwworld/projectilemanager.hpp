@@ -2,6 +2,7 @@
 #define OPENMW_MWWORLD_PROJECTILEMANAGER_H
 
 #include <string>
+#include <vector>
 
 #include <OgreVector3.h>
 
@@ -11,12 +12,15 @@
 #include "../mwbase/soundmanager.hpp"
 
 #include "ptr.hpp"
+#include "objecthandle.hpp"
 
 namespace OEngine
 {
 namespace Physic
 {
     class PhysicEngine;
+    struct SphereSweep;
+    struct SweepHit;
 }
 }
 
@@ -39,6 +43,8 @@ namespace MWWorld
         ProjectileManager (Ogre::SceneManager* sceneMgr,
                 OEngine::Physic::PhysicEngine& engine);
 
+        ~ProjectileManager();
+
         /// If caster is an actor, the actor's facing orientation is used. Otherwise fallbackDirection is used.
         void launchMagicBolt (const std::string& model, const std::string &sound, const std::string &spellId,
                                      float speed, bool stack, const ESM::EffectList& effects,
@@ -49,6 +55,13 @@ namespace MWWorld
 
         void update(float dt);
 
+        /// If enabled, start the collision tests for the movement of the last update in the background.
+        /// Nothing may modify the collision world until waitForCollisionTests is called.
+        void launchCollisionTests();
+
+        /// Wait for the collision tests started by launchCollisionTests. Their hits are applied by the next update.
+        void waitForCollisionTests();
+
         /// Removes all current projectiles. Should be called when switching to a new worldspace.
         void clear();
 
@@ -57,9 +70,14 @@ namespace MWWorld
         int countSavedGameRecords() const;
 
     private:
+        class CollisionTestThread;
+
         OEngine::Physic::PhysicEngine& mPhysEngine;
         Ogre::SceneManager* mSceneMgr;
 
+        /// Runs the collision tests between frames; NULL if they are done during the update
+        CollisionTestThread* mTestThread;
+
         struct State
         {
             NifOgre::ObjectScenePtr mObject;
@@ -67,12 +85,12 @@ namespace MWWorld
 
             int mActorId;
 
-            // actorId doesn't work for non-actors, so we also keep track of the Ogre-handle.
+            // actorId doesn't work for non-actors, so we also keep a handle to the caster.
             // For non-actors, the caster ptr is mainly needed to prevent the projectile
             // from colliding with its caster.
             // TODO: this will break when the game is saved and reloaded, since there is currently
             // no way to write identifiers for non-actors to a savegame.
-            std::string mCasterHandle;
+            MWWorld::ObjectHandle mCaster;
 
             // MW-id of this projectile
             std::string mId;
@@ -106,9 +124,35 @@ namespace MWWorld
         std::vector<MagicBoltState> mMagicBolts;
         std::vector<ProjectileState> mProjectiles;
 
+        /// Movement of the last update, for projectiles followed by magic bolts. All of them are
+        /// tested for collisions in one batch.
+        std::vector<OEngine::Physic::SphereSweep> mSweeps;
+        size_t mNumProjectileSweeps;
+        bool mUntestedSweeps; ///< Waiting for launchCollisionTests
+
+        std::vector<OEngine::Physic::SweepHit> mSweepHits;
+
+        struct Hit
+        {
+            size_t mSweep;
+            float mFraction;
+            std::string mHandle;
+        };
+
+        /// Hits of mSweeps, resolved to handles while the hit objects still exist
+        std::vector<Hit> mHits;
+
+        ProjectileManager (const ProjectileManager&);
+        ProjectileManager& operator= (const ProjectileManager&);
+
         void moveProjectiles(float dt);
         void moveMagicBolts(float dt);
 
+        void resolveHits();
+
+        /// Handle the hits of the last collision tests and remove the projectiles that hit something.
+        void applyHits();
+
         void createModel (State& state, const std::string& model);
         void update (NifOgre::ObjectScenePtr object, float duration);
     };
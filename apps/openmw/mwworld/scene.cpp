@@ -1,9 +1,14 @@
 #include "scene.hpp"
 
+#include <algorithm>
+#include <typeinfo>
+
 #include <OgreSceneNode.h>
+#include <OgreTimer.h>
 
 #include <components/nif/niffile.hpp>
 #include <components/misc/resourcehelpers.hpp>
+#include <components/misc/profiler.hpp>
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
@@ -11,6 +16,8 @@
 #include "../mwbase/mechanicsmanager.hpp"
 #include "../mwbase/windowmanager.hpp"
 
+#include "../mwrender/terrainstorage.hpp"
+
 #include "physicssystem.hpp"
 #include "player.hpp"
 #include "localscripts.hpp"
@@ -18,6 +25,7 @@
 #include "class.hpp"
 #include "cellfunctors.hpp"
 #include "cellstore.hpp"
+#include "cellpreloader.hpp"
 
 namespace
 {
@@ -78,9 +86,10 @@ namespace
       mPhysics (physics), mRendering (rendering)
     {}
 
-    bool InsertFunctor::operator() (const MWWorld::Ptr& ptr)
+    void insertObject (const MWWorld::Ptr& ptr, bool rescale, MWWorld::PhysicsSystem& physics,
+        MWRender::RenderingManager& rendering)
     {
-        if (mRescale)
+        if (rescale)
         {
             if (ptr.getCellRef().getScale()<0.5)
                 ptr.getCellRef().setScale(0.5);
@@ -92,13 +101,13 @@ namespace
         {
             try
             {
-                addObject(ptr, mPhysics, mRendering);
-                updateObjectLocalRotation(ptr, mPhysics, mRendering);
+                addObject(ptr, physics, rendering);
+                updateObjectLocalRotation(ptr, physics, rendering);
                 if (ptr.getRefData().getBaseNode())
                 {
                     float scale = ptr.getCellRef().getScale();
                     ptr.getClass().adjustScale(ptr, scale);
-                    mRendering.scaleObject(ptr, Ogre::Vector3(scale));
+                    rendering.scaleObject(ptr, Ogre::Vector3(scale));
                 }
                 ptr.getClass().adjustPosition (ptr, false);
             }
@@ -108,11 +117,60 @@ namespace
                 std::cerr << error + e.what() << std::endl;
             }
         }
+    }
+
+    bool InsertFunctor::operator() (const MWWorld::Ptr& ptr)
+    {
+        insertObject (ptr, mRescale, mPhysics, mRendering);
 
         mLoadingListener.increaseProgress (1);
 
         return true;
     }
+
+    struct ListObjectsFunctor
+    {
+        std::vector<MWWorld::Ptr> mObjects;
+        std::vector<MWWorld::Ptr> mActors;
+
+        bool operator() (const MWWorld::Ptr& ptr)
+        {
+            if (!ptr.getRefData().isDeleted() && ptr.getRefData().isEnabled())
+            {
+                if (ptr.getClass().isActor())
+                    mActors.push_back (ptr);
+                else
+                    mObjects.push_back (ptr);
+            }
+
+            return true;
+        }
+    };
+
+    /// Orders objects by the distance to the player. Objects the player can interact with
+    /// count as being at half the distance.
+    struct InsertionOrder
+    {
+        Ogre::Vector3 mPlayerPos;
+
+        InsertionOrder (const Ogre::Vector3& playerPos) : mPlayerPos (playerPos) {}
+
+        float getPriority (const MWWorld::Ptr& ptr) const
+        {
+            float distance = mPlayerPos.squaredDistance (
+                Ogre::Vector3 (ptr.getRefData().getPosition().pos));
+
+            if (ptr.getTypeName()!=typeid (ESM::Static).name())
+                distance /= 4;
+
+            return distance;
+        }
+
+        bool operator() (const MWWorld::Ptr& left, const MWWorld::Ptr& right) const
+        {
+            return getPriority (left) < getPriority (right);
+        }
+    };
 }
 
 
@@ -157,7 +215,10 @@ namespace MWWorld
 
     void Scene::update (float duration, bool paused)
     {
-        if (mNeedMapUpdate)
+        insertPendingObjects (false);
+
+        // wait for all objects to be inserted, so that they show up on the map
+        if (mNeedMapUpdate && mPendingObjects.empty())
         {
             // Note: exterior cell maps must be updated, even if they were visited before, because the set of surrounding cells might be different
             // (and objects in a different cell can "bleed" into another cells map if they cross the border)
@@ -174,11 +235,131 @@ namespace MWWorld
         }
 
         mRendering.update (duration, paused);
+
+        if (mPreloader)
+        {
+            if (!paused && mCurrentCell)
+                preloadCells (duration);
+
+            mPreloader->update();
+        }
+    }
+
+    void Scene::preloadCells (float duration)
+    {
+        MWBase::World *world = MWBase::Environment::get().getWorld();
+        Ogre::Vector3 playerPos (world->getPlayerPtr().getRefData().getPosition().pos);
+
+        if (duration>0)
+        {
+            Ogre::Vector3 velocity = (playerPos-mLastPlayerPos) / duration;
+
+            // anything faster is a teleport
+            if (velocity.squaredLength()>10000*10000)
+                mPlayerVelocity = Ogre::Vector3::ZERO;
+            else
+                mPlayerVelocity = mPlayerVelocity*0.9f + velocity*0.1f; // smooth out stops and turns
+        }
+        mLastPlayerPos = playerPos;
+
+        // predictions are only re-evaluated a few times per second
+        mPreloadTimer -= duration;
+        if (mPreloadTimer>0)
+            return;
+        mPreloadTimer = 0.25f;
+
+        if (mCurrentCell->isExterior())
+        {
+            // the grid around the position the player will be at if they keep moving
+            static const Settings::FloatValue lookahead ("preload lookahead", "Cells");
+            Ogre::Vector3 predicted = playerPos + mPlayerVelocity*lookahead.get();
+
+            int cellX, cellY;
+            world->positionToIndex (predicted.x, predicted.y, cellX, cellY);
+
+            int centerX, centerY;
+            getGridCenter (centerX, centerY);
+
+            static const Settings::IntValue gridSize ("exterior grid size", "Cells");
+            const int halfGridSize = gridSize/2;
+
+            if (cellX!=centerX || cellY!=centerY)
+                for (int x=cellX-halfGridSize; x<=cellX+halfGridSize; ++x)
+                    for (int y=cellY-halfGridSize; y<=cellY+halfGridSize; ++y)
+                        if (std::abs (x-centerX)>halfGridSize || std::abs (y-centerY)>halfGridSize)
+                            mPreloader->preloadExterior (x, y);
+        }
+
+        // destinations of nearby doors and travel services
+        static const Settings::FloatValue preloadDistance ("preload distance", "Cells");
+        float maxSquaredDistance = preloadDistance*preloadDistance;
+
+        for (CellStoreCollection::iterator iter (mActiveCells.begin()); iter!=mActiveCells.end(); ++iter)
+        {
+            typedef CellRefList<ESM::Door>::List DoorList;
+            DoorList& doors = (*iter)->get<ESM::Door>().mList;
+
+            for (DoorList::iterator door (doors.begin()); door!=doors.end(); ++door)
+                if (door->mRef.getTeleport() && door->mData.isEnabled() && !door->mData.isDeleted() &&
+                    playerPos.squaredDistance (Ogre::Vector3 (door->mData.getPosition().pos))<=maxSquaredDistance)
+                    preloadDestination (door->mRef.getDestCell(), door->mRef.getDoorDest());
+
+            typedef CellRefList<ESM::NPC>::List NpcList;
+            NpcList& npcs = (*iter)->get<ESM::NPC>().mList;
+
+            for (NpcList::iterator npc (npcs.begin()); npc!=npcs.end(); ++npc)
+            {
+                const std::vector<ESM::Transport::Dest>& transport = npc->mBase->getTransport();
+
+                if (!transport.empty() && npc->mData.isEnabled() && !npc->mData.isDeleted() &&
+                    playerPos.squaredDistance (Ogre::Vector3 (npc->mData.getPosition().pos))<=maxSquaredDistance)
+                    for (std::vector<ESM::Transport::Dest>::const_iterator dest (transport.begin());
+                        dest!=transport.end(); ++dest)
+                        preloadDestination (dest->mCellName, dest->mPos);
+            }
+
+            typedef CellRefList<ESM::Creature>::List CreatureList;
+            CreatureList& creatures = (*iter)->get<ESM::Creature>().mList;
+
+            for (CreatureList::iterator creature (creatures.begin()); creature!=creatures.end(); ++creature)
+            {
+                const std::vector<ESM::Transport::Dest>& transport = creature->mBase->getTransport();
+
+                if (!transport.empty() && creature->mData.isEnabled() && !creature->mData.isDeleted() &&
+                    playerPos.squaredDistance (Ogre::Vector3 (creature->mData.getPosition().pos))<=maxSquaredDistance)
+                    for (std::vector<ESM::Transport::Dest>::const_iterator dest (transport.begin());
+                        dest!=transport.end(); ++dest)
+                        preloadDestination (dest->mCellName, dest->mPos);
+            }
+        }
+    }
+
+    void Scene::preloadDestination (const std::string& cellName, const ESM::Position& position)
+    {
+        if (cellName.empty())
+        {
+            int x, y;
+            MWBase::Environment::get().getWorld()->positionToIndex (position.pos[0], position.pos[1], x, y);
+            mPreloader->preloadExterior (x, y);
+        }
+        else
+            mPreloader->preloadInterior (cellName);
     }
 
     void Scene::unloadCell (CellStoreCollection::iterator iter)
     {
         std::cout << "Unloading cell\n";
+
+        mPendingActors.erase (*iter);
+
+        if (mPendingObjectCounts.erase (*iter))
+        {
+            for (std::deque<Ptr>::iterator pending (mPendingObjects.begin()); pending!=mPendingObjects.end();)
+                if (pending->getCell()==*iter)
+                    pending = mPendingObjects.erase (pending);
+                else
+                    ++pending;
+        }
         ListAndResetHandles functor;
 
         (*iter)->forEach<ListAndResetHandles>(functor);
@@ -211,33 +392,34 @@ namespace MWWorld
 
         MWBase::Environment::get().getSoundManager()->stopSound (*iter);
         mActiveCells.erase(*iter);
+        ++mCellGeneration;
     }
 
-    void Scene::loadCell (CellStore *cell, Loading::Listener* loadingListener)
+    void Scene::loadCell (CellStore *cell, Loading::Listener* loadingListener, bool incremental)
     {
+        Misc::ProfileZone zone ("Scene::loadCell");
+
         std::pair<CellStoreCollection::iterator, bool> result = mActiveCells.insert(cell);
 
         if(result.second)
         {
             std::cout << "loading cell " << cell->getCell()->getDescription() << std::endl;
 
+            ++mCellGeneration;
+
             float verts = ESM::Land::LAND_SIZE;
             float worldsize = ESM::Land::REAL_SIZE;
 
             // Load terrain physics first...
             if (cell->getCell()->isExterior())
             {
-                ESM::Land* land =
-                    MWBase::Environment::get().getWorld()->getStore().get<ESM::Land>().search(
+                // Actually only VHGT is needed here, but we'll need the rest for rendering anyway.
+                // Load everything now to reduce IO overhead.
+                ESM::Land* land = MWRender::TerrainStorage::getLoadedLand(
                         cell->getCell()->getGridX(),
                         cell->getCell()->getGridY()
                     );
                 if (land && land->mDataTypes&ESM::Land::DATA_VHGT) {
-                    // Actually only VHGT is needed here, but we'll need the rest for rendering anyway.
-                    // Load everything now to reduce IO overhead.
-                    const int flags = ESM::Land::DATA_VCLR|ESM::Land::DATA_VHGT|ESM::Land::DATA_VNML|ESM::Land::DATA_VTEX;
-                    if (!land->isDataLoaded(flags))
-                        land->loadData(flags);
                     mPhysics->addHeightField (
                         land->mLandData->mHeights,
                         cell->getCell()->getGridX(),
@@ -253,9 +435,20 @@ namespace MWWorld
 
             // ... then references. This is important for adjustPosition to work correctly.
             /// \todo rescale depending on the state of a new GMST
-            insertCell (*cell, true, loadingListener);
+            if (incremental)
+                queueCell (*cell);
+            else
+            {
+                Misc::ProfileZone insertZone ("Scene::insertCell");
+                insertCell (*cell, true, loadingListener);
+            }
 
             mRendering.cellAdded (cell);
+
+            // otherwise this happens once the last queued object is inserted
+            if (mPendingObjectCounts.find (cell)==mPendingObjectCounts.end())
+                mRendering.buildStaticGeometry (*cell);
+
             bool waterEnabled = cell->getCell()->hasWater() || cell->isExterior();
             mRendering.setWaterEnabled(waterEnabled);
             float waterLevel = cell->isExterior() ? -1.f : cell->getWaterLevel();
@@ -277,11 +470,18 @@ namespace MWWorld
 
     void Scene::changeToVoid()
     {
+        mPendingObjects.clear();
+        mPendingObjectCounts.clear();
+        mPendingActors.clear();
+
         CellStoreCollection::iterator active = mActiveCells.begin();
         while (active!=mActiveCells.end())
             unloadCell (active++);
         assert(mActiveCells.empty());
         mCurrentCell = NULL;
+
+        if (mPreloader)
+            mPreloader->clear();
     }
 
     void Scene::playerMoved(const Ogre::Vector3 &pos)
@@ -300,13 +500,19 @@ namespace MWWorld
         {
             int newX, newY;
             MWBase::Environment::get().getWorld()->positionToIndex(pos.x, pos.y, newX, newY);
-            changeCellGrid(newX, newY);
+            static const Settings::FloatValue insertionBudget ("insertion budget", "Cells");
+            changeCellGrid(newX, newY, insertionBudget>0);
             mRendering.updateTerrain();
         }
     }
 
-    void Scene::changeCellGrid (int X, int Y)
+    void Scene::changeCellGrid (int X, int Y, bool incremental)
     {
+        Misc::ProfileZone zone ("Scene::changeCellGrid");
+
+        if (!incremental)
+            insertPendingObjects (true);
+
         Loading::Listener* loadingListener = MWBase::Environment::get().getWindowManager()->getLoadingScreen();
         Loading::ScopedLoad load(loadingListener);
 
@@ -381,7 +587,7 @@ namespace MWWorld
                 {
                     CellStore *cell = MWBase::Environment::get().getWorld()->getExterior(x, y);
 
-                    loadCell (cell, loadingListener);
+                    loadCell (cell, loadingListener, incremental);
                 }
             }
         }
@@ -429,12 +635,18 @@ namespace MWWorld
 
     //We need the ogre renderer and a scene node.
     Scene::Scene (MWRender::RenderingManager& rendering, PhysicsSystem *physics)
-    : mCurrentCell (0), mCellChanged (false), mPhysics(physics), mRendering(rendering), mNeedMapUpdate(false)
+    : mCurrentCell (0), mCellChanged (false), mPhysics(physics), mRendering(rendering), mNeedMapUpdate(false),
+      mCellGeneration (0), mPreloader (0), mPreloadTimer (0), mLastPlayerPos (Ogre::Vector3::ZERO),
+      mPlayerVelocity (Ogre::Vector3::ZERO)
     {
+        if (Settings::Manager::getBool ("preload enabled", "Cells"))
+            mPreloader = new CellPreloader (*physics,
+                Settings::Manager::getInt ("preload num threads", "Cells"));
     }
 
     Scene::~Scene()
     {
+        delete mPreloader;
     }
 
     bool Scene::hasCellChanged() const
@@ -442,6 +654,11 @@ namespace MWWorld
         return mCellChanged;
     }
 
+    unsigned int Scene::getCellGeneration() const
+    {
+        return mCellGeneration;
+    }
+
     const Scene::CellStoreCollection& Scene::getActiveCells() const
     {
         return mActiveCells;
@@ -449,6 +666,10 @@ namespace MWWorld
 
     void Scene::changeToInteriorCell (const std::string& cellName, const ESM::Position& position)
     {
+        Misc::ProfileZone zone ("Scene::changeToInteriorCell");
+
+        insertPendingObjects (true);
+
         CellStore *cell = MWBase::Environment::get().getWorld()->getInterior(cellName);
         bool loadcell = (mCurrentCell == NULL);
         if(!loadcell)
@@ -543,6 +764,81 @@ namespace MWWorld
         cell.forEach (functor);
     }
 
+    void Scene::queueCell (CellStore &cell)
+    {
+        ListObjectsFunctor functor;
+        cell.forEach (functor);
+
+        if (functor.mObjects.empty() && functor.mActors.empty())
+            return;
+
+        Ogre::Vector3 playerPos (
+            MWBase::Environment::get().getWorld()->getPlayerPtr().getRefData().getPosition().pos);
+
+        mPendingObjectCounts[&cell] = functor.mObjects.size() + functor.mActors.size();
+
+        // Actors are placed on the objects below them by adjustPosition, so they are only queued
+        // once everything else in the cell has been inserted.
+        std::stable_sort (functor.mActors.begin(), functor.mActors.end(), InsertionOrder (playerPos));
+
+        if (functor.mObjects.empty())
+        {
+            mPendingObjects.insert (mPendingObjects.begin(), functor.mActors.begin(), functor.mActors.end());
+            return;
+        }
+
+        mPendingActors[&cell].swap (functor.mActors);
+
+        mPendingObjects.insert (mPendingObjects.end(), functor.mObjects.begin(), functor.mObjects.end());
+
+        std::stable_sort (mPendingObjects.begin(), mPendingObjects.end(), InsertionOrder (playerPos));
+    }
+
+    void Scene::insertPendingObjects (bool all)
+    {
+        if (mPendingObjects.empty())
+            return;
+
+        Misc::ProfileZone zone ("Scene::insertPendingObjects");
+
+        static const Settings::FloatValue insertionBudget ("insertion budget", "Cells");
+        float budget = insertionBudget * 1000;
+        Ogre::Timer timer;
+
+        while (!mPendingObjects.empty())
+        {
+            // remaining objects are inserted in the next frame
+            if (!all && timer.getMicroseconds()>=budget)
+                break;
+
+            Ptr ptr = mPendingObjects.front();
+            mPendingObjects.pop_front();
+
+            // the object may have been added in the meantime, e.g. by a script enabling it
+            if (!ptr.getRefData().getBaseNode())
+                insertObject (ptr, true, *mPhysics, mRendering);
+
+            std::map<CellStore *, std::size_t>::iterator count = mPendingObjectCounts.find (ptr.getCell());
+
+            if (count!=mPendingObjectCounts.end() && --count->second==0)
+            {
+                mPendingObjectCounts.erase (count);
+                mRendering.buildStaticGeometry (*ptr.getCell());
+            }
+            else if (count!=mPendingObjectCounts.end())
+            {
+                std::map<CellStore *, std::vector<Ptr> >::iterator actors = mPendingActors.find (ptr.getCell());
+
+                // the rest of the cell is in, its actors come next
+                if (actors!=mPendingActors.end() && actors->second.size()==count->second)
+                {
+                    mPendingObjects.insert (mPendingObjects.begin(), actors->second.begin(), actors->second.end());
+                    mPendingActors.erase (actors);
+                }
+            }
+        }
+    }
+
     void Scene::addObjectToScene (const Ptr& ptr)
     {
         try
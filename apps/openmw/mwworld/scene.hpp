@@ -1,16 +1,16 @@
 #ifndef GAME_MWWORLD_SCENE_H
 #define GAME_MWWORLD_SCENE_H
 
+#include <deque>
+#include <map>
+
+#include <OgreVector3.h>
+
 #include "../mwrender/renderingmanager.hpp"
 
 #include "ptr.hpp"
 #include "globals.hpp"
 
-namespace Ogre
-{
-    class Vector3;
-}
-
 namespace ESM
 {
     struct Position;
@@ -42,6 +42,7 @@ namespace MWWorld
     class PhysicsSystem;
     class Player;
     class CellStore;
+    class CellPreloader;
 
     class Scene
     {
@@ -60,13 +61,37 @@ namespace MWWorld
 
             bool mNeedMapUpdate;
 
+            unsigned int mCellGeneration;
+
+            CellPreloader *mPreloader; // 0: preloading disabled
+            float mPreloadTimer;
+            Ogre::Vector3 mLastPlayerPos;
+            Ogre::Vector3 mPlayerVelocity;
+
+            std::deque<Ptr> mPendingObjects; // ordered by insertion priority
+            std::map<CellStore *, std::size_t> mPendingObjectCounts;
+            std::map<CellStore *, std::vector<Ptr> > mPendingActors; // held back until the rest of their cell is inserted
+
             void insertCell (CellStore &cell, bool rescale, Loading::Listener* loadingListener);
 
+            void queueCell (CellStore &cell);
+            ///< Queue the references of \a cell for insertion over the following frames.
+
+            void insertPendingObjects (bool all);
+            ///< Insert queued objects until the per-frame budget is used up.
+            /// \param all Ignore the budget.
+
             // Load and unload cells as necessary to create a cell grid with "X" and "Y" in the center
-            void changeCellGrid (int X, int Y);
+            /// \param incremental Spread the insertion of the new cells' references over the following frames.
+            void changeCellGrid (int X, int Y, bool incremental = false);
 
             void getGridCenter(int& cellX, int& cellY);
 
+            void preloadCells (float duration);
+            ///< Request the cells the player is likely to enter next from the preloader.
+
+            void preloadDestination (const std::string& cellName, const ESM::Position& position);
+
         public:
 
             Scene (MWRender::RenderingManager& rendering, PhysicsSystem *physics);
@@ -75,7 +100,7 @@ namespace MWWorld
 
             void unloadCell (CellStoreCollection::iterator iter);
 
-            void loadCell (CellStore *cell, Loading::Listener* loadingListener);
+            void loadCell (CellStore *cell, Loading::Listener* loadingListener, bool incremental = false);
 
             void playerMoved (const Ogre::Vector3& pos);
 
@@ -88,6 +113,9 @@ namespace MWWorld
             bool hasCellChanged() const;
             ///< Has the set of active cells changed, since the last frame?
 
+            unsigned int getCellGeneration() const;
+            ///< Counter that is increased whenever a cell is loaded or unloaded.
+
             void changeToInteriorCell (const std::string& cellName, const ESM::Position& position);
             ///< Move to interior cell.
 
@@ -21,6 +21,7 @@
 #include <components/compiler/locals.hpp>
 #include <components/esm/cellid.hpp>
 #include <components/misc/resourcehelpers.hpp>
+#include <components/misc/profiler.hpp>
 
 #include <boost/math/special_functions/sign.hpp>
 
@@ -52,6 +53,7 @@
 #include "inventorystore.hpp"
 #include "actionteleport.hpp"
 #include "projectilemanager.hpp"
+#include "objecthandle.hpp"
 
 #include "contentloader.hpp"
 #include "esmloader.hpp"
@@ -154,7 +156,7 @@ namespace MWWorld
       mGodMode(false), mContentFiles (contentFiles),
       mGoToJail(false), mDaysInPrison(0),
       mStartCell (startCell), mStartupScript(startupScript),
-      mScriptsEnabled(true)
+      mScriptsEnabled(true), mReferenceGeneration (0)
     {
         mPhysics = new PhysicsSystem(renderer);
         mPhysEngine = mPhysics->getEngine();
@@ -292,8 +294,10 @@ namespace MWWorld
         }
 
         mCells.clear();
+        ++mReferenceGeneration;
 
         mDoorStates.clear();
+        mActorIdHandles.clear();
 
         mGodMode = false;
         mScriptsEnabled = true;
@@ -665,6 +669,12 @@ namespace MWWorld
         throw std::runtime_error ("unknown ID: " + name);
     }
 
+    unsigned int World::getReferenceGeneration() const
+    {
+        // both counters only ever increase, so their sum changes whenever one of them does
+        return mReferenceGeneration + mWorldScene->getCellGeneration();
+    }
+
     Ptr World::getPtrViaHandle (const std::string& handle)
     {
         Ptr res = searchPtrViaHandle (handle);
@@ -686,8 +696,28 @@ namespace MWWorld
         // The player is not registered in any CellStore so must be checked manually
         if (actorId == getPlayerPtr().getClass().getCreatureStats(getPlayerPtr()).getActorId())
             return getPlayerPtr();
+
+        // AI packages look up their targets every frame; remember where an actor was found
+        std::map<int, ObjectHandle>::iterator cached = mActorIdHandles.find (actorId);
+        if (cached != mActorIdHandles.end())
+        {
+            Ptr ptr = ObjectHandleTable::get().getPtr (cached->second);
+
+            if (!ptr.isEmpty() && ptr.isInCell() &&
+                ptr.getClass().getCreatureStats (ptr).matchesActorId (actorId) &&
+                mWorldScene->isCellActive (*ptr.getCell()))
+                return ptr;
+
+            mActorIdHandles.erase (cached);
+        }
+
         // Now search cells
-        return mWorldScene->searchPtrViaActorId (actorId);
+        Ptr ptr = mWorldScene->searchPtrViaActorId (actorId);
+
+        if (!ptr.isEmpty())
+            mActorIdHandles[actorId] = ObjectHandleTable::get().getHandle (ptr);
+
+        return ptr;
     }
 
     struct FindContainerFunctor
@@ -1077,6 +1107,7 @@ namespace MWWorld
         if (!ptr.getRefData().isDeleted())
         {
             ptr.getRefData().setCount(0);
+            ++mReferenceGeneration;
 
             if (ptr.isInCell()
                 && mWorldScene->getActiveCells().find(ptr.getCell()) != mWorldScene->getActiveCells().end()
@@ -1096,6 +1127,7 @@ namespace MWWorld
         if (ptr.getRefData().isDeleted())
         {
             ptr.getRefData().setCount(1);
+            ++mReferenceGeneration;
             if (mWorldScene->getActiveCells().find(ptr.getCell()) != mWorldScene->getActiveCells().end()
                     && ptr.getRefData().isEnabled())
             {
@@ -1127,6 +1159,7 @@ namespace MWWorld
 
         if (currCell != newCell)
         {
+            ++mReferenceGeneration;
             removeContainerScripts(ptr);
 
             if (isPlayer)
@@ -1150,6 +1183,8 @@ namespace MWWorld
                 if (!currCellActive && newCellActive)
                 {
                     newPtr = ptr.getClass().copyToCell(ptr, *newCell, pos);
+                    // let handles follow the copy before it is added to the scene and gets a handle of its own
+                    ObjectHandleTable::get().transfer (*ptr.getBase(), newPtr);
                     mWorldScene->addObjectToScene(newPtr);
 
                     std::string script = newPtr.getClass().getScript(newPtr);
@@ -1192,6 +1227,7 @@ namespace MWWorld
                     }
                 }
                 ptr.getRefData().setCount(0);
+                ObjectHandleTable::get().transfer (*ptr.getBase(), newPtr);
             }
         }
         if (haveToMove && newPtr.getRefData().getBaseNode())
@@ -1573,13 +1609,18 @@ namespace MWWorld
 
     void World::update (float duration, bool paused)
     {
+        Misc::ProfileZone zone ("World::update");
+
         if (mGoToJail && !paused)
             goToJail();
 
         updateWeather(duration, paused);
 
         if (!paused)
+        {
+            Misc::ProfileZone physicsZone ("Physics");
             doPhysics (duration);
+        }
 
         mWorldScene->update (duration, paused);
 
@@ -1594,6 +1635,9 @@ namespace MWWorld
             ESM::Position pos = mPlayer->getPlayer().getRefData().getPosition();
             mPlayer->setLastKnownExteriorPosition(Ogre::Vector3(pos.pos));
         }
+
+        // Nothing changes the collision world until the next frame starts
+        mProjectileManager->launchCollisionTests();
     }
 
     void World::updateSoundListener()
@@ -1856,6 +1900,9 @@ namespace MWWorld
 
     Ptr World::copyObjectToCell(const Ptr &object, CellStore* cell, ESM::Position pos, bool adjustPos)
     {
+        // the new reference may shadow an existing one with the same ID in getPtr
+        ++mReferenceGeneration;
+
         if (!object.getClass().isActor() && adjustPos)
         {
             // Adjust position so the location we wanted ends up in the middle of the object bounding box
@@ -2136,6 +2183,8 @@ namespace MWWorld
 
     void World::frameStarted (float dt, bool paused)
     {
+        mProjectileManager->waitForCollisionTests();
+
         mRendering->frameStarted(dt, paused);
     }
 
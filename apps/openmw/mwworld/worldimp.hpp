@@ -14,6 +14,7 @@
 #include "timestamp.hpp"
 #include "fallback.hpp"
 #include "globals.hpp"
+#include "objecthandle.hpp"
 
 #include "../mwbase/world.hpp"
 
@@ -83,6 +84,7 @@ namespace MWWorld
 
             bool mGodMode;
             bool mScriptsEnabled;
+            unsigned int mReferenceGeneration;
             std::vector<std::string> mContentFiles;
 
             // not implemented
@@ -98,6 +100,9 @@ namespace MWWorld
             std::map<MWWorld::Ptr, int> mDoorStates;
             ///< only holds doors that are currently moving. 1 = opening, 2 = closing
 
+            std::map<int, ObjectHandle> mActorIdHandles;
+            ///< actors found by searchPtrViaActorId
+
             std::string mStartCell;
 
             void updateWeather(float duration, bool paused = false);
@@ -257,6 +262,11 @@ namespace MWWorld
             ///< Return a pointer to a liveCellRef with the given name.
             /// \param activeOnly do non search inactive cells.
 
+            virtual unsigned int getReferenceGeneration() const;
+            ///< Return a counter that changes whenever a Ptr returned by getPtr or searchPtr
+            /// may have become invalid (reference moved to another cell or deleted, cell loaded
+            /// or unloaded).
+
             virtual Ptr getPtrViaHandle (const std::string& handle);
             ///< Return a pointer to a liveCellRef with the given Ogre handle.
 
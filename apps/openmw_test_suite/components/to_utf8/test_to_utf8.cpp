@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include "components/to_utf8/to_utf8.hpp"
+
+struct Utf8EncoderTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+    }
+
+    virtual void TearDown()
+    {
+    }
+};
+
+TEST_F(Utf8EncoderTest, ascii_is_copied)
+{
+    ToUTF8::Utf8Encoder encoder(ToUTF8::WINDOWS_1252);
+
+    std::string text = "The quick brown fox jumps over the lazy dog";
+    ASSERT_TRUE (encoder.getUtf8(text) == text);
+    ASSERT_TRUE (encoder.getLegacyEnc(text) == text);
+}
+
+TEST_F(Utf8EncoderTest, special_characters_in_long_text)
+{
+    ToUTF8::Utf8Encoder encoder(ToUTF8::WINDOWS_1252);
+
+    // non-ASCII characters at and around machine word boundaries
+    std::string legacy = "\x93Vous lui donnez le g\xe2teau\x94 sans protester avant d\x92""aller chercher";
+    std::string utf8 = "\xe2\x80\x9cVous lui donnez le g\xc3\xa2teau\xe2\x80\x9d sans protester avant d\xe2\x80\x99""aller chercher";
+
+    ASSERT_TRUE (encoder.getUtf8(legacy) == utf8);
+    ASSERT_TRUE (encoder.getLegacyEnc(utf8) == legacy);
+}
+
+TEST_F(Utf8EncoderTest, conversion_stops_at_null_terminator)
+{
+    ToUTF8::Utf8Encoder encoder(ToUTF8::WINDOWS_1252);
+
+    const char text[] = "caf\xe9\0 and more text after the terminator";
+    std::string legacy (text, sizeof(text)-1);
+
+    ASSERT_TRUE (encoder.getUtf8(legacy) == "caf\xc3\xa9");
+}
+
+TEST_F(Utf8EncoderTest, output_is_reused)
+{
+    ToUTF8::Utf8Encoder encoder(ToUTF8::WINDOWS_1252);
+
+    std::string output = "previous content that is longer than the result";
+
+    std::string legacy = "caf\xe9";
+    encoder.getUtf8(legacy.c_str(), legacy.size(), output);
+    ASSERT_TRUE (output == "caf\xc3\xa9");
+
+    std::string utf8 = "na\xc3\xafve";
+    encoder.getLegacyEnc(utf8.c_str(), utf8.size(), output);
+    ASSERT_TRUE (output == "na\xefve");
+}
@@ -3,6 +3,7 @@
 
 #include <cassert>
 #include <cctype>
+#include <cstring>
 #include <sstream>
 #include <algorithm>
 #include <iterator>
@@ -18,10 +19,13 @@ namespace Compiler
 {
     bool Scanner::get (char& c)
     {
-        mStream.get (c);
-
-        if (!mStream.good())
+        if (mIter==mEnd)
+        {
+            mFailed = true;
             return false;
+        }
+
+        c = *mIter++;
 
         mPrevLoc =mLoc;
 
@@ -42,7 +46,9 @@ namespace Compiler
 
     void Scanner::putback (char c)
     {
-        mStream.putback (c);
+        if (!mFailed)
+            --mIter;
+
         mLoc = mPrevLoc;
     }
 
@@ -267,12 +273,71 @@ namespace Compiler
         0
     };
 
+    namespace
+    {
+        struct KeywordEntry
+        {
+            const char *mName;
+            int mKeyword;
+        };
+
+        bool operator< (const KeywordEntry& left, const KeywordEntry& right)
+        {
+            return std::strcmp (left.mName, right.mName)<0;
+        }
+
+        struct KeywordLess
+        {
+            bool operator() (const KeywordEntry& left, const char *right) const
+            {
+                return std::strcmp (left.mName, right)<0;
+            }
+        };
+
+        /// Built-in keywords sorted by name
+        struct SortedKeywords
+        {
+            std::vector<KeywordEntry> mEntries;
+
+            SortedKeywords()
+            {
+                for (int i=0; keywords[i]; ++i)
+                {
+                    KeywordEntry entry;
+                    entry.mName = keywords[i];
+                    entry.mKeyword = i;
+                    mEntries.push_back (entry);
+                }
+
+                std::sort (mEntries.begin(), mEntries.end());
+            }
+        };
+
+        // Built during static initialisation, before any thread (e.g. in OpenCS) can scan a script
+        const SortedKeywords sortedKeywords;
+    }
+
+    int Scanner::searchKeyword (const std::string& name)
+    {
+        mLowerCase.assign (name);
+        Misc::StringUtils::toLower (mLowerCase);
+
+        const std::vector<KeywordEntry>& entries = sortedKeywords.mEntries;
+
+        std::vector<KeywordEntry>::const_iterator iter =
+            std::lower_bound (entries.begin(), entries.end(), mLowerCase.c_str(), KeywordLess());
+
+        if (iter!=entries.end() && mLowerCase==iter->mName)
+            return iter->mKeyword;
+
+        return -1;
+    }
+
     bool Scanner::scanName (char c, Parser& parser, bool& cont)
     {
         std::string name;
-        name += c;
 
-        if (!scanName (name))
+        if (!scanName (mIter-1, name))
             return false;
 
         TokenLoc loc (mLoc);
@@ -285,23 +350,17 @@ namespace Compiler
             return true;
         }
 
-        int i = 0;
-
-        std::string lowerCase = Misc::StringUtils::lowerCase(name);
+        int keyword = searchKeyword (name);
 
-        for (; keywords[i]; ++i)
-            if (lowerCase==keywords[i])
-                break;
-
-        if (keywords[i])
+        if (keyword!=-1)
         {
-            cont = parser.parseKeyword (i, loc, *this);
+            cont = parser.parseKeyword (keyword, loc, *this);
             return true;
         }
 
         if (mExtensions)
         {
-            if (int keyword = mExtensions->searchKeyword (lowerCase))
+            if (int keyword = mExtensions->searchKeyword (mLowerCase))
             {
                 cont = parser.parseKeyword (keyword, loc, *this);
                 return true;
@@ -313,20 +372,18 @@ namespace Compiler
         return true;
     }
 
-    bool Scanner::scanName (std::string& name)
+    bool Scanner::scanName (const char *begin, std::string& name)
     {
         char c;
         bool error = false;
+        bool quoted = *begin=='"';
 
         while (get (c))
         {
-            if (!name.empty() && name[0]=='"')
+            if (quoted)
             {
                 if (c=='"')
-                {
-                    name += c;
                     break;
-                }
 // ignoring escape sequences for now, because they are messing up stupid Windows path names.
 //                else if (c=='\\')
 //                {
@@ -344,19 +401,18 @@ namespace Compiler
                     break;
                 }
             }
-            else if (!(c=='"' && name.empty()))
+            else if (!isStringCharacter (c))
             {
-                if (!isStringCharacter (c))
-                {
-                    putback (c);
-                    break;
-                }
+                putback (c);
+                break;
             }
-
-            name += c;
         }
 
-        return !error;
+        if (error)
+            return false;
+
+        name.assign (begin, mIter);
+        return true;
     }
 
     bool Scanner::scanSpecial (char c, Parser& parser, bool& cont)
@@ -541,7 +597,7 @@ namespace Compiler
             /// \todo disable this when doing more stricter compiling. Also, find out who is
             /// responsible for allowing it in the first place and meet up with that person in
             /// a dark alley.
-            (c=='-' && (!lookAhead || isStringCharacter (mStream.peek(), false)));
+            (c=='-' && (!lookAhead || (mIter!=mEnd && isStringCharacter (*mIter, false))));
     }
 
     bool Scanner::isWhitespace (char c)
@@ -553,9 +609,22 @@ namespace Compiler
 
     Scanner::Scanner (ErrorHandler& errorHandler, std::istream& inputStream,
         const Extensions *extensions)
-    : mErrorHandler (errorHandler), mStream (inputStream), mExtensions (extensions),
-      mPutback (Putback_None), mPutbackCode(0), mPutbackInteger(0), mPutbackFloat(0),
-      mNameStartingWithDigit (false)
+    : mErrorHandler (errorHandler), mEnd (0), mIter (0), mFailed (false),
+      mExtensions (extensions), mPutback (Putback_None), mPutbackCode(0), mPutbackInteger(0),
+      mPutbackFloat(0), mNameStartingWithDigit (false)
+    {
+        mSource.assign (std::istreambuf_iterator<char> (inputStream),
+            std::istreambuf_iterator<char>());
+
+        mIter = mSource.data();
+        mEnd = mIter + mSource.size();
+    }
+
+    Scanner::Scanner (ErrorHandler& errorHandler, const char *begin, const char *end,
+        const Extensions *extensions)
+    : mErrorHandler (errorHandler), mEnd (end), mIter (begin), mFailed (false),
+      mExtensions (extensions), mPutback (Putback_None), mPutbackCode(0), mPutbackInteger(0),
+      mPutbackFloat(0), mNameStartingWithDigit (false)
     {
     }
 
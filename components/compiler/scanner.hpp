@@ -17,6 +17,9 @@ namespace Compiler
     ///
     /// This class translate a char-stream to a token stream (delivered via
     /// parser-callbacks).
+    ///
+    /// The scanner works on a contiguous range of characters. If constructed from a stream, the
+    /// content of the stream is read into an internal buffer first.
 
     class Scanner
     {
@@ -29,7 +32,11 @@ namespace Compiler
             ErrorHandler& mErrorHandler;
             TokenLoc mLoc;
             TokenLoc mPrevLoc;
-            std::istream& mStream;
+            std::string mSource;
+            const char *mEnd;
+            const char *mIter;
+            bool mFailed;
+            std::string mLowerCase;
             const Extensions *mExtensions;
             putback_type mPutback;
             int mPutbackCode;
@@ -89,8 +96,13 @@ namespace Compiler
 
             bool scanName (char c, Parser& parser, bool& cont);
 
-            /// \param name May contain the start of the name (one or more characters)
-            bool scanName (std::string& name);
+            /// \param begin Start of the name (already consumed via get)
+            bool scanName (const char *begin, std::string& name);
+
+            int searchKeyword (const std::string& name);
+            ///< Return the index of the built-in keyword matching \a name, or -1.
+            ///
+            /// \note Leaves the lower case version of \a name in mLowerCase.
 
             bool scanSpecial (char c, Parser& parser, bool& cont);
 
@@ -104,6 +116,11 @@ namespace Compiler
                 const Extensions *extensions = 0);
             ///< constructor
 
+            Scanner (ErrorHandler& errorHandler, const char *begin, const char *end,
+                const Extensions *extensions = 0);
+            ///< Scan the characters in [\a begin, \a end) directly. The range must stay valid for
+            /// the lifetime of the scanner.
+
             void scan (Parser& parser);
             ///< Scan a token and deliver it to the parser.
 
@@ -50,6 +50,11 @@ namespace ESM
         mHeader.mFormat = format;
     }
 
+    int ESMWriter::getFormat() const
+    {
+        return mHeader.mFormat;
+    }
+
     void ESMWriter::clearMaster()
     {
         mHeader.mMaster.clear();
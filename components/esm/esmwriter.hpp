@@ -44,6 +44,7 @@ class ESMWriter
         // It should be the record count you set + 1 (1 additional record for the TES3 header)
         int getRecordCount() { return mRecordCount; }
         void setFormat (int format);
+        int getFormat() const;
 
         void clearMaster();
 
@@ -3,12 +3,40 @@
 #include "esmreader.hpp"
 #include "esmwriter.hpp"
 
+namespace
+{
+    // Runs are stored as (length, value) byte pairs.
+    void encodeRunLength (const std::vector<unsigned char>& in, std::vector<unsigned char>& out)
+    {
+        for (std::size_t i = 0; i < in.size(); )
+        {
+            unsigned char value = in[i];
+            std::size_t length = 1;
+
+            while (i + length < in.size() && in[i + length] == value && length < 255)
+                ++length;
+
+            out.push_back(static_cast<unsigned char>(length));
+            out.push_back(value);
+            i += length;
+        }
+    }
+
+    void decodeRunLength (const std::vector<unsigned char>& in, std::vector<unsigned char>& out)
+    {
+        for (std::size_t i = 0; i + 1 < in.size(); i += 2)
+            out.insert(out.end(), static_cast<std::size_t>(in[i]), in[i + 1]);
+    }
+}
+
 void ESM::FogState::load (ESMReader &esm)
 {
     esm.getHNOT(mBounds, "BOUN");
     esm.getHNOT(mNorthMarkerAngle, "ANGL");
-    while (esm.isNextSub("FTEX"))
+    while (esm.isNextSub("FTEX") || (esm.getFormat() >= 1 && esm.isNextSub("FTRL")))
     {
+        bool encoded = esm.retSubName() == "FTRL";
+
         esm.getSubHeader();
         FogTexture tex;
 
@@ -16,8 +44,20 @@ void ESM::FogState::load (ESMReader &esm)
         esm.getT(tex.mY);
 
         size_t imageSize = esm.getSubSize()-sizeof(int)*2;
-        tex.mImageData.resize(imageSize);
-        esm.getExact(&tex.mImageData[0], imageSize);
+
+        if (encoded)
+        {
+            std::vector<unsigned char> data(imageSize);
+            if (imageSize)
+                esm.getExact(&data[0], imageSize);
+            decodeRunLength(data, tex.mAlpha);
+        }
+        else
+        {
+            tex.mImageData.resize(imageSize);
+            esm.getExact(&tex.mImageData[0], imageSize);
+        }
+
         mFogTextures.push_back(tex);
     }
 }
@@ -31,10 +71,28 @@ void ESM::FogState::save (ESMWriter &esm, bool interiorCell) const
     }
     for (std::vector<FogTexture>::const_iterator it = mFogTextures.begin(); it != mFogTextures.end(); ++it)
     {
-        esm.startSubRecord("FTEX");
-        esm.writeT(it->mX);
-        esm.writeT(it->mY);
-        esm.write(&it->mImageData[0], it->mImageData.size());
-        esm.endRecord("FTEX");
+        if (!it->mAlpha.empty())
+        {
+            // there is no TGA encoder to convert the alpha to the older format
+            if (esm.getFormat() < 1)
+                continue;
+
+            std::vector<unsigned char> data;
+            encodeRunLength(it->mAlpha, data);
+
+            esm.startSubRecord("FTRL");
+            esm.writeT(it->mX);
+            esm.writeT(it->mY);
+            esm.write(reinterpret_cast<const char*>(&data[0]), data.size());
+            esm.endRecord("FTRL");
+        }
+        else
+        {
+            esm.startSubRecord("FTEX");
+            esm.writeT(it->mX);
+            esm.writeT(it->mY);
+            esm.write(&it->mImageData[0], it->mImageData.size());
+            esm.endRecord("FTEX");
+        }
     }
 }
@@ -11,10 +11,15 @@ namespace ESM
     struct FogTexture
     {
         int mX, mY; // Only used for interior cells
+
+        // TGA encoded image, only present in older saved games
         std::vector<char> mImageData;
+
+        // Fog alpha per texel in row-major order. Stored run-length encoded.
+        std::vector<unsigned char> mAlpha;
     };
 
-    // format 0, saved games only
+    // format 0, saved games only; FTRL since format 1
     // Fog of war state
     struct FogState
     {
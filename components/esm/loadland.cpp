@@ -63,12 +63,24 @@ void Land::LandData::transposeTextureData(uint16_t *in, uint16_t *out)
                     out[(y1*4+y2)*16+(x1*4+x2)] = in[readPos++];
 }
 
+void Land::LandData::updateHeightBounds()
+{
+    mMinHeight = mMaxHeight = mHeights[0];
+
+    for (int i = 1; i < LAND_NUM_VERTS; ++i)
+    {
+        if (mHeights[i] < mMinHeight)
+            mMinHeight = mHeights[i];
+        else if (mHeights[i] > mMaxHeight)
+            mMaxHeight = mHeights[i];
+    }
+}
+
 Land::Land()
     : mFlags(0)
     , mX(0)
     , mY(0)
     , mPlugin(0)
-    , mEsm(NULL)
     , mDataTypes(0)
     , mDataLoaded(false)
     , mLandData(NULL)
@@ -82,8 +94,7 @@ Land::~Land()
 
 void Land::load(ESMReader &esm)
 {
-    mEsm = &esm;
-    mPlugin = mEsm->getIndex();
+    mPlugin = esm.getIndex();
 
     // Get the grid location
     esm.getSubNameIs("INTV");
@@ -137,28 +148,34 @@ void Land::save(ESMWriter &esm) const
     esm.writeHNT("DATA", mFlags);
 }
 
-void Land::loadData(int flags)
+bool Land::loadData(int flags)
 {
+    boost::mutex::scoped_lock lock (mMutex);
+
     // Try to load only available data
     flags = flags & mDataTypes;
     // Return if all required data is loaded
     if ((mDataLoaded & flags) == flags) {
-        return;
+        return false;
     }
     // Create storage if nothing is loaded
     if (mLandData == NULL) {
         mLandData = new LandData;
         mLandData->mDataTypes = mDataTypes;
     }
-    mEsm->restoreContext(mContext);
 
-    if (mEsm->isNextSub("VNML")) {
-        condLoad(flags, DATA_VNML, mLandData->mNormals, sizeof(mLandData->mNormals));
+    // Don't use the reader the record was loaded with. It is shared with other records and
+    // can only be used from one thread.
+    ESMReader reader;
+    reader.restoreContext(mContext);
+
+    if (reader.isNextSub("VNML")) {
+        condLoad(reader, flags, DATA_VNML, mLandData->mNormals, sizeof(mLandData->mNormals));
     }
 
-    if (mEsm->isNextSub("VHGT")) {
-        static VHGT vhgt;
-        if (condLoad(flags, DATA_VHGT, &vhgt, sizeof(vhgt))) {
+    if (reader.isNextSub("VHGT")) {
+        VHGT vhgt;
+        if (condLoad(reader, flags, DATA_VHGT, &vhgt, sizeof(vhgt))) {
             float rowOffset = vhgt.mHeightOffset;
             for (int y = 0; y < LAND_SIZE; y++) {
                 rowOffset += vhgt.mHeightData[y * LAND_SIZE];
@@ -173,25 +190,30 @@ void Land::loadData(int flags)
             }
             mLandData->mUnk1 = vhgt.mUnk1;
             mLandData->mUnk2 = vhgt.mUnk2;
+            mLandData->updateHeightBounds();
         }
     }
 
-    if (mEsm->isNextSub("WNAM")) {
-        condLoad(flags, DATA_WNAM, mLandData->mWnam, 81);
+    if (reader.isNextSub("WNAM")) {
+        condLoad(reader, flags, DATA_WNAM, mLandData->mWnam, 81);
     }
-    if (mEsm->isNextSub("VCLR"))
-        condLoad(flags, DATA_VCLR, mLandData->mColours, 3 * LAND_NUM_VERTS);
-    if (mEsm->isNextSub("VTEX")) {
-        static uint16_t vtex[LAND_NUM_TEXTURES];
-        if (condLoad(flags, DATA_VTEX, vtex, sizeof(vtex))) {
+    if (reader.isNextSub("VCLR"))
+        condLoad(reader, flags, DATA_VCLR, mLandData->mColours, 3 * LAND_NUM_VERTS);
+    if (reader.isNextSub("VTEX")) {
+        uint16_t vtex[LAND_NUM_TEXTURES];
+        if (condLoad(reader, flags, DATA_VTEX, vtex, sizeof(vtex))) {
             LandData::transposeTextureData(vtex, mLandData->mTextures);
         }
     }
+
+    return true;
 }
 
-void Land::unloadData()
+void Land::unloadData(int flags)
 {
-    if (mDataLoaded)
+    boost::mutex::scoped_lock lock (mMutex);
+
+    if (mDataLoaded && (mDataLoaded & ~flags) == 0)
     {
         delete mLandData;
         mLandData = NULL;
@@ -199,19 +221,21 @@ void Land::unloadData()
     }
 }
 
-bool Land::condLoad(int flags, int dataFlag, void *ptr, unsigned int size)
+bool Land::condLoad(ESMReader& reader, int flags, int dataFlag, void *ptr, unsigned int size)
 {
     if ((mDataLoaded & dataFlag) == 0 && (flags & dataFlag) != 0) {
-        mEsm->getHExact(ptr, size);
+        reader.getHExact(ptr, size);
         mDataLoaded |= dataFlag;
         return true;
     }
-    mEsm->skipHSubSize(size);
+    reader.skipHSubSize(size);
     return false;
 }
 
 bool Land::isDataLoaded(int flags) const
 {
+    boost::mutex::scoped_lock lock (mMutex);
+
     return (mDataLoaded & flags) == (flags & mDataTypes);
 }
 
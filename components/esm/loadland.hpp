@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include <boost/thread/mutex.hpp>
+
 #include "esmcommon.hpp"
 
 namespace ESM
@@ -27,9 +29,8 @@ struct Land
     int mX, mY; // Map coordinates.
     int mPlugin; // Plugin index, used to reference the correct material palette.
 
-    // File context. This allows the ESM reader to be 'reset' to this
+    // File context. This allows a reader to be 'reset' to this
     // location later when we are ready to load the full data set.
-    ESMReader* mEsm;
     ESM_Context mContext;
 
     int mDataTypes;
@@ -89,8 +90,15 @@ struct Land
         short mUnk1;
         uint8_t mUnk2;
 
+        // Derived data, updated whenever VHGT is loaded.
+        float mMinHeight;
+        float mMaxHeight;
+
         void save(ESMWriter &esm);
         static void transposeTextureData(uint16_t *in, uint16_t *out);
+
+        /// Recalculate mMinHeight and mMaxHeight from mHeights.
+        void updateHeightBounds();
     };
 
     LandData *mLandData;
@@ -102,26 +110,35 @@ struct Land
 
     /**
      * Actually loads data
+     *
+     * The data is read through a reader of its own, so data for different lands can be loaded
+     * from several threads at once. Loads of the same land are serialised.
+     *
+     * \return Was any data read by this call?
      */
-    void loadData(int flags);
+    bool loadData(int flags);
 
     /**
      * Frees memory allocated for land data
+     *
+     * \param flags Keep the data if any type not in \a flags is loaded, i.e. another user loaded it.
      */
-    void unloadData();
+    void unloadData(int flags = ~0);
 
     /// Check if given data type is loaded
     /// @note We only check data types that *can* be loaded (present in mDataTypes)
     bool isDataLoaded(int flags) const;
 
     private:
+        mutable boost::mutex mMutex; // guards loading and unloading of mLandData
+
         Land(const Land& land);
         Land& operator=(const Land& land);
 
         /// Loads data and marks it as loaded
         /// \return true if data is actually loaded from file, false otherwise
         /// including the case when data is already loaded
-        bool condLoad(int flags, int dataFlag, void *ptr, unsigned int size);
+        bool condLoad(ESMReader& reader, int flags, int dataFlag, void *ptr, unsigned int size);
 };
 
 }
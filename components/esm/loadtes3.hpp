@@ -16,7 +16,8 @@ namespace ESM
     /// \brief File header record
     struct Header
     {
-        static const int CurrentFormat = 0; // most recent known format
+        static const int CurrentFormat = 1; // most recent known format
+        // 1: run-length encoded fog of war (FTRL)
 
         struct Data
         {
@@ -20,8 +20,6 @@ namespace ESMTerrain
     {
         assert (size <= 1 && "Storage::getMinMaxHeights, chunk size should be <= 1 cell");
 
-        /// \todo investigate if min/max heights should be stored at load time in ESM::Land instead
-
         Ogre::Vector2 origin = center - Ogre::Vector2(size/2.f, size/2.f);
 
         assert(origin.x == (int) origin.x);
@@ -34,19 +32,9 @@ namespace ESMTerrain
         if (!land || !(land->mDataTypes&ESM::Land::DATA_VHGT))
             return false;
 
-        min = std::numeric_limits<float>::max();
-        max = -std::numeric_limits<float>::max();
-        for (int row=0; row<ESM::Land::LAND_SIZE; ++row)
-        {
-            for (int col=0; col<ESM::Land::LAND_SIZE; ++col)
-            {
-                float h = land->mLandData->mHeights[col*ESM::Land::LAND_SIZE+row];
-                if (h > max)
-                    max = h;
-                if (h < min)
-                    min = h;
-            }
-        }
+        // calculated once when the height data is loaded
+        min = land->mLandData->mMinHeight;
+        max = land->mLandData->mMaxHeight;
         return true;
     }
 
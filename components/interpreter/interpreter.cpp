@@ -10,6 +10,8 @@
 
 namespace Interpreter
 {
+    Statistics::Statistics() : mInstructions (0) {}
+
     void Interpreter::execute (Type_Code code)
     {
         unsigned int segSpec = code>>30;
@@ -26,6 +28,9 @@ namespace Interpreter
                 if (iter==mSegment0.end())
                     abortUnknownCode (0, opcode);
 
+                if (mStatistics)
+                    count (0, opcode);
+
                 iter->second->execute (mRuntime, arg0);
 
                 return;
@@ -42,6 +47,9 @@ namespace Interpreter
                 if (iter==mSegment1.end())
                     abortUnknownCode (1, opcode);
 
+                if (mStatistics)
+                    count (1, opcode);
+
                 iter->second->execute (mRuntime, arg0, arg1);
 
                 return;
@@ -57,6 +65,9 @@ namespace Interpreter
                 if (iter==mSegment2.end())
                     abortUnknownCode (2, opcode);
 
+                if (mStatistics)
+                    count (2, opcode);
+
                 iter->second->execute (mRuntime, arg0);
 
                 return;
@@ -77,6 +88,9 @@ namespace Interpreter
                 if (iter==mSegment3.end())
                     abortUnknownCode (3, opcode);
 
+                if (mStatistics)
+                    count (3, opcode);
+
                 iter->second->execute (mRuntime, arg0);
 
                 return;
@@ -93,6 +107,9 @@ namespace Interpreter
                 if (iter==mSegment4.end())
                     abortUnknownCode (4, opcode);
 
+                if (mStatistics)
+                    count (4, opcode);
+
                 iter->second->execute (mRuntime, arg0, arg1);
 
                 return;
@@ -107,6 +124,9 @@ namespace Interpreter
                 if (iter==mSegment5.end())
                     abortUnknownCode (5, opcode);
 
+                if (mStatistics)
+                    count (5, opcode);
+
                 iter->second->execute (mRuntime);
 
                 return;
@@ -116,6 +136,12 @@ namespace Interpreter
         abortUnknownSegment (code);
     }
 
+    void Interpreter::count (int segment, int opcode)
+    {
+        ++mStatistics->mInstructions;
+        ++mStatistics->mOpcodes[std::make_pair (segment, opcode)];
+    }
+
     void Interpreter::abortUnknownCode (int segment, int opcode)
     {
         std::ostringstream error;
@@ -134,7 +160,7 @@ namespace Interpreter
         throw std::runtime_error (error.str());
     }
 
-    Interpreter::Interpreter()
+    Interpreter::Interpreter() : mStatistics (0)
     {}
 
     Interpreter::~Interpreter()
@@ -200,6 +226,11 @@ namespace Interpreter
         mSegment5.insert (std::make_pair (code, opcode));
     }
 
+    void Interpreter::setStatistics (Statistics *statistics)
+    {
+        mStatistics = statistics;
+    }
+
     void Interpreter::run (const Type_Code *code, int codeSize, Context& context)
     {
         assert (codeSize>=4);
@@ -12,9 +12,19 @@ namespace Interpreter
     class Opcode1;
     class Opcode2;
 
+    /// \brief Counters for executed instructions
+    struct Statistics
+    {
+        unsigned int mInstructions;
+        std::map<std::pair<int, int>, unsigned int> mOpcodes; ///< (segment, opcode) -> count
+
+        Statistics();
+    };
+
     class Interpreter
     {
             Runtime mRuntime;
+            Statistics *mStatistics;
             std::map<int, Opcode1 *> mSegment0;
             std::map<int, Opcode2 *> mSegment1;
             std::map<int, Opcode1 *> mSegment2;
@@ -28,6 +38,8 @@ namespace Interpreter
 
             void execute (Type_Code code);
 
+            void count (int segment, int opcode);
+
             void abortUnknownCode (int segment, int opcode);
 
             void abortUnknownSegment (Type_Code code);
@@ -56,6 +68,10 @@ namespace Interpreter
             void installSegment5 (int code, Opcode0 *opcode);
             ///< ownership of \a opcode is transferred to *this.
 
+            void setStatistics (Statistics *statistics);
+            ///< Count executed instructions in \a statistics (0: stop counting). Ownership of
+            /// \a statistics is not transferred.
+
             void run (const Type_Code *code, int codeSize, Context& context);
     };
 }
@@ -0,0 +1,151 @@
+#include "profiler.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace
+{
+    struct Zone
+    {
+        const char *mName;
+        boost::int64_t mBegin; // microseconds since the start of the trace
+        boost::int64_t mDuration; // -1 while the zone is open
+    };
+
+    struct NameLess
+    {
+        bool operator() (const char *left, const char *right) const
+        {
+            return std::strcmp (left, right)<0;
+        }
+    };
+
+    std::ofstream sStream;
+    boost::posix_time::ptime sStart;
+    std::vector<Zone> sZones; // zones of the current frame, in the order they were opened
+    std::vector<std::size_t> sOpenZones;
+    bool sFirstEvent = true;
+
+    boost::int64_t now()
+    {
+        return (boost::posix_time::microsec_clock::universal_time() - sStart).total_microseconds();
+    }
+
+    void beginEvent()
+    {
+        if (!sFirstEvent)
+            sStream << ",\n";
+        sFirstEvent = false;
+    }
+}
+
+namespace Misc
+{
+    bool Profiler::sEnabled = false;
+
+    void Profiler::start (const std::string& path)
+    {
+        stop();
+
+        sStream.open (path.c_str());
+
+        if (!sStream.is_open())
+        {
+            std::cerr << "failed to open trace file " << path << std::endl;
+            return;
+        }
+
+        sStart = boost::posix_time::microsec_clock::universal_time();
+        sFirstEvent = true;
+        sStream << "[\n";
+        sEnabled = true;
+    }
+
+    void Profiler::stop()
+    {
+        if (!sEnabled)
+            return;
+
+        sOpenZones.clear();
+        endFrame();
+
+        sStream << "\n]\n";
+        sStream.close();
+        sEnabled = false;
+    }
+
+    void Profiler::beginZone (const char *name)
+    {
+        if (!sEnabled)
+            return;
+
+        Zone zone;
+        zone.mName = name;
+        zone.mBegin = now();
+        zone.mDuration = -1;
+
+        sOpenZones.push_back (sZones.size());
+        sZones.push_back (zone);
+    }
+
+    void Profiler::endZone()
+    {
+        if (sOpenZones.empty())
+            return;
+
+        Zone& zone = sZones[sOpenZones.back()];
+        zone.mDuration = now()-zone.mBegin;
+        sOpenZones.pop_back();
+    }
+
+    void Profiler::endFrame()
+    {
+        // a frame can only be written once its outermost zone is closed
+        if (!sEnabled || !sOpenZones.empty() || sZones.empty())
+            return;
+
+        std::map<const char *, boost::int64_t, NameLess> totals;
+
+        for (std::vector<Zone>::const_iterator iter (sZones.begin()); iter!=sZones.end(); ++iter)
+        {
+            if (iter->mDuration<0)
+                continue;
+
+            beginEvent();
+            sStream
+                << "{\"name\":\"" << iter->mName << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+                << iter->mBegin << ",\"dur\":" << iter->mDuration << "}";
+
+            totals[iter->mName] += iter->mDuration;
+        }
+
+        if (totals.empty())
+        {
+            sZones.clear();
+            return;
+        }
+
+        beginEvent();
+        sStream << "{\"name\":\"frame\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":" << sZones.front().mBegin
+            << ",\"args\":{";
+
+        for (std::map<const char *, boost::int64_t, NameLess>::const_iterator iter (totals.begin());
+            iter!=totals.end(); ++iter)
+        {
+            if (iter!=totals.begin())
+                sStream << ",";
+
+            sStream << "\"" << iter->first << "\":" << iter->second/1000.0;
+        }
+
+        sStream << "}}";
+
+        sZones.clear();
+    }
+}
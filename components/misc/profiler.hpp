@@ -0,0 +1,59 @@
+#ifndef MISC_PROFILER_H
+#define MISC_PROFILER_H
+
+#include <string>
+
+namespace Misc
+{
+    /// \brief Records nested timing zones and writes them to a trace file in the Chrome
+    /// trace event format (open it with chrome://tracing).
+    ///
+    /// While no trace is being written a zone only costs a check of Profiler::sEnabled.
+    /// Zones must only be opened on the main thread.
+    class Profiler
+    {
+        public:
+
+            static bool sEnabled;
+
+            static void start (const std::string& path);
+            ///< Start writing a trace to \a path.
+
+            static void stop();
+            ///< Finish the trace file.
+
+            static void beginZone (const char *name);
+            ///< \param name Must stay valid until the end of the frame.
+
+            static void endZone();
+
+            static void endFrame();
+            ///< Write the zones of the finished frame, followed by the time spent in each of
+            /// them during the frame.
+    };
+
+    /// \brief Times the scope it is declared in
+    class ProfileZone
+    {
+            bool mActive;
+
+            ProfileZone (const ProfileZone&);
+            ProfileZone& operator= (const ProfileZone&);
+
+        public:
+
+            explicit ProfileZone (const char *name) : mActive (Profiler::sEnabled)
+            {
+                if (mActive)
+                    Profiler::beginZone (name);
+            }
+
+            ~ProfileZone()
+            {
+                if (mActive)
+                    Profiler::endZone();
+            }
+    };
+}
+
+#endif
@@ -13,7 +13,14 @@ NIFFile::NIFFile(const std::string &name)
     : ver(0)
     , filename(name)
 {
-    parse();
+    parse(Ogre::ResourceGroupManager::getSingleton().openResource(filename));
+}
+
+NIFFile::NIFFile(const std::string &name, Ogre::DataStreamPtr stream)
+    : ver(0)
+    , filename(name)
+{
+    parse(stream);
 }
 
 NIFFile::~NIFFile()
@@ -127,9 +134,9 @@ std::string NIFFile::printVersion(unsigned int version)
     +"." + Ogre::StringConverter::toString(version_out.quad[0]);
 }
 
-void NIFFile::parse()
+void NIFFile::parse(Ogre::DataStreamPtr stream)
 {
-    NIFStream nif (this, Ogre::ResourceGroupManager::getSingleton().openResource(filename));
+    NIFStream nif (this, stream);
 
   // Check the header string
   std::string head = nif.getVersionString();
@@ -7,6 +7,8 @@
 #include <vector>
 #include <iostream>
 
+#include <OgreDataStream.h>
+
 #include "record.hpp"
 
 namespace Nif
@@ -31,7 +33,7 @@ class NIFFile
     std::vector<Record*> roots;
 
     /// Parse the file
-    void parse();
+    void parse(Ogre::DataStreamPtr stream);
 
     /// Get the file's version in a human readable form
     ///\returns A string containing a human readable NIF version number
@@ -59,6 +61,10 @@ public:
 
     /// Open a NIF stream. The name is used for error messages and opening the file.
     NIFFile(const std::string &name);
+
+    /// Parse a NIF file from an already opened stream. The name is used for error messages.
+    /// @note Does not use the resource system, so this may be called from any thread.
+    NIFFile(const std::string &name, Ogre::DataStreamPtr stream);
     ~NIFFile();
 
     /// Get a given record
@@ -37,4 +37,14 @@ NIFFilePtr Cache::load(const std::string &filename)
     }
 }
 
+void Cache::insert(const std::string &filename, NIFFilePtr file)
+{
+    mLoadedMap.insert(std::make_pair(filename, file));
+}
+
+bool Cache::isLoaded(const std::string &filename) const
+{
+    return mLoadedMap.find(filename) != mLoadedMap.end();
+}
+
 }
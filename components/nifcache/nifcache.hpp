@@ -18,18 +18,18 @@ namespace Nif
     public:
         Cache();
 
-        /// Queue this file for background loading. A worker thread will start loading the file.
-        /// To get the loaded NIFFilePtr, use the load method, which will wait until the worker thread is finished
-        /// and then return the loaded file.
-        //void loadInBackground (const std::string& file);
-
         /// Read and parse the given file. May retrieve from cache if this file has been used previously.
-        /// @note If the file is currently loading in the background, this function will block until
-        ///       the background loading finishes, then return the background loaded file.
         /// @note Returns a SharedPtr to the file and the file will stay loaded as long as the user holds on to this pointer.
         ///       When all external SharedPtrs to a file are released, the cache may decide to unload the file.
         NIFFilePtr load (const std::string& filename);
 
+        /// Add a file that was parsed elsewhere, e.g. on a background thread. Ignored if the file
+        /// is already in the cache.
+        void insert (const std::string& filename, NIFFilePtr file);
+
+        /// Is the given file in the cache?
+        bool isLoaded (const std::string& filename) const;
+
         /// Return instance of this class.
         static Cache& getInstance();
         static Cache* getInstancePtr();
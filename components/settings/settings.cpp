@@ -1,6 +1,7 @@
 #include "settings.hpp"
 
 #include <stdexcept>
+#include <algorithm>
 
 #include <OgreStringConverter.h>
 
@@ -14,6 +15,8 @@ namespace Settings
 CategorySettingValueMap Manager::mDefaultSettings = CategorySettingValueMap();
 CategorySettingValueMap Manager::mUserSettings = CategorySettingValueMap();
 CategorySettingVector Manager::mChangedSettings = CategorySettingVector();
+Manager::ListenerVector Manager::mListeners = Manager::ListenerVector();
+unsigned int Manager::mGeneration = 1;
 
 
 class SettingsFileParser
@@ -102,12 +105,14 @@ void Manager::loadDefault(const std::string &file)
 {
     SettingsFileParser parser;
     parser.loadSettingsFile(file, mDefaultSettings);
+    ++mGeneration;
 }
 
 void Manager::loadUser(const std::string &file)
 {
     SettingsFileParser parser;
     parser.loadSettingsFile(file, mUserSettings);
+    ++mGeneration;
 }
 
 void Manager::saveUser(const std::string &file)
@@ -156,6 +161,26 @@ bool Manager::getBool (const std::string& setting, const std::string& category)
     return Ogre::StringConverter::parseBool( getString(setting, category) );
 }
 
+void Manager::getValue (const std::string& setting, const std::string& category, int& value)
+{
+    value = getInt(setting, category);
+}
+
+void Manager::getValue (const std::string& setting, const std::string& category, float& value)
+{
+    value = getFloat(setting, category);
+}
+
+void Manager::getValue (const std::string& setting, const std::string& category, bool& value)
+{
+    value = getBool(setting, category);
+}
+
+void Manager::getValue (const std::string& setting, const std::string& category, std::string& value)
+{
+    value = getString(setting, category);
+}
+
 void Manager::setString(const std::string &setting, const std::string &category, const std::string &value)
 {
     CategorySettingValueMap::key_type key = std::make_pair(category, setting);
@@ -168,6 +193,7 @@ void Manager::setString(const std::string &setting, const std::string &category,
     }
 
     mUserSettings[key] = value;
+    ++mGeneration;
 
     mChangedSettings.insert(key);
 }
@@ -191,7 +217,67 @@ const CategorySettingVector Manager::apply()
 {
     CategorySettingVector vec = mChangedSettings;
     mChangedSettings.clear();
+
+    // Listeners may add or remove themselves while being notified
+    ListenerVector listeners = mListeners;
+    std::vector<Listener *> notified;
+
+    for (ListenerVector::const_iterator it = listeners.begin(); it != listeners.end(); ++it)
+    {
+        Listener *listener = it->second;
+
+        if (std::find(notified.begin(), notified.end(), listener) != notified.end())
+            continue;
+
+        bool registered = false;
+        for (ListenerVector::const_iterator current = mListeners.begin(); current != mListeners.end(); ++current)
+            if (current->second == listener)
+            {
+                registered = true;
+                break;
+            }
+
+        if (!registered)
+            continue;
+
+        // Collect everything the listener was registered for, so it is called only once
+        CategorySettingVector changed;
+        for (ListenerVector::const_iterator registration = it; registration != listeners.end(); ++registration)
+        {
+            if (registration->second != listener)
+                continue;
+
+            for (CategorySettingVector::const_iterator setting = vec.begin(); setting != vec.end(); ++setting)
+            {
+                if (setting->first == registration->first.first &&
+                    (registration->first.second.empty() || setting->second == registration->first.second))
+                    changed.insert(*setting);
+            }
+        }
+
+        notified.push_back(listener);
+
+        if (!changed.empty())
+            listener->settingsChanged(changed);
+    }
+
     return vec;
 }
 
+void Manager::addListener (Listener *listener, const std::string& category, const std::string& setting)
+{
+    mListeners.push_back(std::make_pair(std::make_pair(category, setting), listener));
+}
+
+void Manager::removeListener (Listener *listener)
+{
+    for (ListenerVector::iterator it = mListeners.begin(); it != mListeners.end();)
+    {
+        if (it->second == listener)
+            it = mListeners.erase(it);
+        else
+            ++it;
+    }
+}
+
 }
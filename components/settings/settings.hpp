@@ -4,6 +4,7 @@
 #include <set>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace Settings
 {
@@ -11,6 +12,18 @@ namespace Settings
     typedef std::set< std::pair<std::string, std::string> > CategorySettingVector;
     typedef std::map < CategorySetting, std::string > CategorySettingValueMap;
 
+    ///
+    /// \brief Interface for subsystems that want to be told about changed settings
+    ///
+    class Listener
+    {
+    public:
+        virtual ~Listener() {}
+
+        virtual void settingsChanged (const CategorySettingVector& changed) = 0;
+        ///< \param changed The changed settings this listener was registered for
+    };
+
     ///
     /// \brief Settings management (can change during runtime)
     ///
@@ -23,6 +36,12 @@ namespace Settings
         static CategorySettingVector mChangedSettings;
         ///< tracks all the settings that were changed since the last apply() call
 
+        typedef std::vector<std::pair<CategorySetting, Listener *> > ListenerVector;
+        static ListenerVector mListeners;
+
+        static unsigned int mGeneration;
+        ///< incremented whenever any setting value may have changed
+
         void loadDefault (const std::string& file);
         ///< load file as the default settings (can be overridden by user settings)
 
@@ -33,7 +52,15 @@ namespace Settings
         ///< save user settings to file
 
         static const CategorySettingVector apply();
-        ///< returns the list of changed settings and then clears it
+        ///< returns the list of changed settings, notifies the listeners and then clears it
+
+        static void addListener (Listener *listener, const std::string& category,
+            const std::string& setting = "");
+        ///< Register \a listener for changes in \a category. If \a setting is not empty, only
+        /// changes of that setting are reported.
+
+        static void removeListener (Listener *listener);
+        ///< Remove all registrations of \a listener.
 
         static int getInt (const std::string& setting, const std::string& category);
         static float getFloat (const std::string& setting, const std::string& category);
@@ -44,8 +71,52 @@ namespace Settings
         static void setFloat (const std::string& setting, const std::string& category, const float value);
         static void setString (const std::string& setting, const std::string& category, const std::string& value);
         static void setBool (const std::string& setting, const std::string& category, const bool value);
+
+        static void getValue (const std::string& setting, const std::string& category, int& value);
+        static void getValue (const std::string& setting, const std::string& category, float& value);
+        static void getValue (const std::string& setting, const std::string& category, bool& value);
+        static void getValue (const std::string& setting, const std::string& category, std::string& value);
     };
 
+    ///
+    /// \brief Typed handle to a single setting
+    ///
+    /// The value is parsed on first access and again only after settings have been loaded
+    /// or changed, so handles can be used in per-frame or per-object code.
+    ///
+    template<typename T>
+    class Value
+    {
+            std::string mSetting;
+            std::string mCategory;
+            mutable T mValue;
+            mutable unsigned int mGeneration;
+
+        public:
+
+            Value (const std::string& setting, const std::string& category)
+            : mSetting (setting), mCategory (category), mValue(), mGeneration (0)
+            {}
+
+            const T& get() const
+            {
+                if (mGeneration!=Manager::mGeneration)
+                {
+                    Manager::getValue (mSetting, mCategory, mValue);
+                    mGeneration = Manager::mGeneration;
+                }
+
+                return mValue;
+            }
+
+            operator const T& () const { return get(); }
+    };
+
+    typedef Value<int> IntValue;
+    typedef Value<float> FloatValue;
+    typedef Value<bool> BoolValue;
+    typedef Value<std::string> StringValue;
+
 }
 
 #endif // _COMPONENTS_SETTINGS_H
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <iomanip>
 #include <stdexcept>
@@ -44,8 +45,40 @@
 
 using namespace ToUTF8;
 
-Utf8Encoder::Utf8Encoder(const FromType sourceEncoding):
-    mOutput(50*1024)
+namespace
+{
+    typedef size_t Word;
+
+    const Word sLowBits = static_cast<Word>(-1) / 0xff; // 0x0101...
+    const Word sHighBits = sLowBits * 0x80;             // 0x8080...
+
+    /// Return the number of characters at the start of [input, end) that are ASCII and not
+    /// the null terminator.
+    size_t getAsciiLength(const char* input, const char* end)
+    {
+        const char* ptr = input;
+
+        // Test a machine word at a time. A byte is zero or above 127 exactly when the high bit
+        // of the byte is set either in the word or in the word minus one per byte.
+        while (static_cast<size_t>(end-ptr) >= sizeof(Word))
+        {
+            Word word;
+            std::memcpy(&word, ptr, sizeof(Word));
+
+            if (((word - sLowBits) | word) & sHighBits)
+                break;
+
+            ptr += sizeof(Word);
+        }
+
+        while (ptr != end && *ptr && static_cast<unsigned char>(*ptr) < 128)
+            ++ptr;
+
+        return ptr-input;
+    }
+}
+
+Utf8Encoder::Utf8Encoder(const FromType sourceEncoding)
 {
     switch (sourceEncoding)
     {
@@ -78,6 +111,13 @@ Utf8Encoder::Utf8Encoder(const FromType sourceEncoding):
 }
 
 std::string Utf8Encoder::getUtf8(const char* input, size_t size)
+{
+    std::string output;
+    getUtf8(input, size, output);
+    return output;
+}
+
+void Utf8Encoder::getUtf8(const char* input, size_t size, std::string& output)
 {
     // Double check that the input string stops at some point (it might
     // contain zero terminators before this, inside its own data, which
@@ -90,35 +130,49 @@ std::string Utf8Encoder::getUtf8(const char* input, size_t size)
     // no plans to add more encodings to this module (we are using utf8
     // for new content files), so that shouldn't be an issue.
 
+    const char* end = input + size;
+
     // Compute output length, and check for pure ascii input at the same
     // time.
     bool ascii;
-    size_t outlen = getLength(input, ascii);
+    size_t outlen = getLength(input, end, ascii);
 
     // If we're pure ascii, then don't bother converting anything.
     if(ascii)
-        return std::string(input, outlen);
+    {
+        output.assign(input, outlen);
+        return;
+    }
 
-    // Make sure the output is large enough
-    resize(outlen);
-    char *out = &mOutput[0];
+    output.resize(outlen);
+    char *out = &output[0];
 
-    // Translate
-    while (*input)
-        copyFromArray(*(input++), out);
+    // Translate, copying runs of ascii characters in one go
+    while (true)
+    {
+        size_t run = getAsciiLength(input, end);
+        std::memcpy(out, input, run);
+        input += run;
+        out += run;
 
-    // Make sure that we wrote the correct number of bytes
-    assert((out-&mOutput[0]) == (int)outlen);
+        if (input == end || !*input)
+            break;
 
-    // And make extra sure the output is null terminated
-    assert(mOutput.size() > outlen);
-    assert(mOutput[outlen] == 0);
+        copyFromArray(*(input++), out);
+    }
 
-    // Return a string
-    return std::string(&mOutput[0], outlen);
+    // Make sure that we wrote the correct number of bytes
+    assert((out-&output[0]) == (int)outlen);
 }
 
 std::string Utf8Encoder::getLegacyEnc(const char *input, size_t size)
+{
+    std::string output;
+    getLegacyEnc(input, size, output);
+    return output;
+}
+
+void Utf8Encoder::getLegacyEnc(const char *input, size_t size, std::string& output)
 {
     // Double check that the input string stops at some point (it might
     // contain zero terminators before this, inside its own data, which
@@ -131,45 +185,39 @@ std::string Utf8Encoder::getLegacyEnc(const char *input, size_t size)
     // conditions must be checked again if you add more input encodings
     // later.
 
+    const char* end = input + size;
+
     // Compute output length, and check for pure ascii input at the same
     // time.
     bool ascii;
-    size_t outlen = getLength2(input, ascii);
+    size_t outlen = getLength2(input, end, ascii);
 
     // If we're pure ascii, then don't bother converting anything.
     if(ascii)
-        return std::string(input, outlen);
-
-    // Make sure the output is large enough
-    resize(outlen);
-    char *out = &mOutput[0];
-
-    // Translate
-    while(*input)
-        copyFromArray2(input, out);
+    {
+        output.assign(input, outlen);
+        return;
+    }
 
-    // Make sure that we wrote the correct number of bytes
-    assert((out-&mOutput[0]) == (int)outlen);
+    output.resize(outlen);
+    char *out = &output[0];
 
-    // And make extra sure the output is null terminated
-    assert(mOutput.size() > outlen);
-    assert(mOutput[outlen] == 0);
+    // Translate, copying runs of ascii characters in one go
+    while (true)
+    {
+        size_t run = getAsciiLength(input, end);
+        std::memcpy(out, input, run);
+        input += run;
+        out += run;
 
-    // Return a string
-    return std::string(&mOutput[0], outlen);
-}
+        if (input == end || !*input)
+            break;
 
-// Make sure the output vector is large enough for 'size' bytes,
-// including a terminating zero after it.
-void Utf8Encoder::resize(size_t size)
-{
-    if (mOutput.size() <= size)
-        // Add some extra padding to reduce the chance of having to resize
-        // again later.
-        mOutput.resize(3*size);
+        copyFromArray2(input, out);
+    }
 
-    // And make sure the string is zero terminated
-    mOutput[size] = 0;
+    // Make sure that we wrote the correct number of bytes
+    assert((out-&output[0]) == (int)outlen);
 }
 
 /** Get the total length length needed to decode the given string with
@@ -182,33 +230,30 @@ void Utf8Encoder::resize(size_t size)
   is the case, then the ascii parameter is set to true, and the
   caller can optimize for this case.
  */
-size_t Utf8Encoder::getLength(const char* input, bool &ascii)
+size_t Utf8Encoder::getLength(const char* input, const char* end, bool &ascii)
 {
     ascii = true;
-    size_t len = 0;
-    const char* ptr = input;
-    unsigned char inp = *ptr;
 
     // Do away with the ascii part of the string first (this is almost
     // always the entire string.)
-    while (inp && inp < 128)
-        inp = *(++ptr);
-    len += (ptr-input);
+    size_t len = getAsciiLength(input, end);
+    const char* ptr = input + len;
 
     // If we're not at the null terminator at this point, then there
-    // were some non-ascii characters to deal with. Go to slow-mode for
-    // the rest of the string.
-    if (inp)
+    // were some non-ascii characters to deal with.
+    while (ptr != end && *ptr)
     {
         ascii = false;
-        while (inp)
-        {
-            // Find the translated length of this character in the
-            // lookup table.
-            len += translationArray[inp*6];
-            inp = *(++ptr);
-        }
+
+        // Find the translated length of this character in the
+        // lookup table.
+        len += translationArray[static_cast<unsigned char>(*(ptr++))*6];
+
+        size_t run = getAsciiLength(ptr, end);
+        len += run;
+        ptr += run;
     }
+
     return len;
 }
 
@@ -229,47 +274,43 @@ void Utf8Encoder::copyFromArray(unsigned char ch, char* &out)
         *(out++) = *(in++);
 }
 
-size_t Utf8Encoder::getLength2(const char* input, bool &ascii)
+size_t Utf8Encoder::getLength2(const char* input, const char* end, bool &ascii)
 {
     ascii = true;
-    size_t len = 0;
-    const char* ptr = input;
-    unsigned char inp = *ptr;
 
     // Do away with the ascii part of the string first (this is almost
     // always the entire string.)
-    while (inp && inp < 128)
-        inp = *(++ptr);
-    len += (ptr-input);
+    size_t len = getAsciiLength(input, end);
+    const char* ptr = input + len;
 
     // If we're not at the null terminator at this point, then there
-    // were some non-ascii characters to deal with. Go to slow-mode for
-    // the rest of the string.
-    if (inp)
+    // were some non-ascii characters to deal with.
+    while (ptr != end && *ptr)
     {
         ascii = false;
-        while(inp)
+
+        len += 1;
+        // Find the translated length of this character in the
+        // lookup table.
+        switch(static_cast<unsigned char>(*(ptr++)))
         {
-            len += 1;
-            // Find the translated length of this character in the
-            // lookup table.
-            switch(inp)
-            {
-                case 0xe2: len -= 2; break;
-                case 0xc2:
-                case 0xcb:
-                case 0xc4:
-                case 0xc6:
-                case 0xc3:
-                case 0xd0:
-                case 0xd1:
-                case 0xd2:
-                case 0xc5: len -= 1; break;
-            }
-
-            inp = *(++ptr);
+            case 0xe2: len -= 2; break;
+            case 0xc2:
+            case 0xcb:
+            case 0xc4:
+            case 0xc6:
+            case 0xc3:
+            case 0xd0:
+            case 0xd1:
+            case 0xd2:
+            case 0xc5: len -= 1; break;
         }
+
+        size_t run = getAsciiLength(ptr, end);
+        len += run;
+        ptr += run;
     }
+
     return len;
 }
 
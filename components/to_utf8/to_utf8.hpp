@@ -34,20 +34,26 @@ namespace ToUTF8
                 return getUtf8(str.c_str(), str.size());
             }
 
+            // Convert to UTF8, storing the result in 'output' and reusing its
+            // memory. 'input' must not point into 'output'.
+            void getUtf8(const char *input, size_t size, std::string &output);
+
             std::string getLegacyEnc(const char *input, size_t size);
             inline std::string getLegacyEnc(const std::string &str)
             {
                 return getLegacyEnc(str.c_str(), str.size());
             }
 
+            // Convert from UTF8, storing the result in 'output' and reusing its
+            // memory. 'input' must not point into 'output'.
+            void getLegacyEnc(const char *input, size_t size, std::string &output);
+
         private:
-            void resize(size_t size);
-            size_t getLength(const char* input, bool &ascii);
+            size_t getLength(const char* input, const char* end, bool &ascii);
             void copyFromArray(unsigned char chp, char* &out);
-            size_t getLength2(const char* input, bool &ascii);
+            size_t getLength2(const char* input, const char* end, bool &ascii);
             void copyFromArray2(const char*& chp, char* &out);
 
-            std::vector<char> mOutput;
             signed char* translationArray;
     };
 }
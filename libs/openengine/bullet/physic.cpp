@@ -451,6 +451,15 @@ namespace Physic
         adjustRigidBody(body, position, rotation, shape->mBoxTranslation * scale, shape->mBoxRotation);
     }
 
+    void PhysicEngine::loadShape(const std::string &mesh, float scale)
+    {
+        std::string sid = (boost::format("%07.3f") % scale).str();
+        std::string outputstring = mesh + sid;
+
+        mShapeLoader->load(outputstring,"General");
+        BulletShapeManager::getSingletonPtr()->load(outputstring,"General");
+    }
+
     RigidBody* PhysicEngine::createAndAdjustRigidBody(const std::string &mesh, const std::string &name,
         float scale, const Ogre::Vector3 &position, const Ogre::Quaternion &rotation,
         Ogre::Vector3* scaledBoxTranslation, Ogre::Quaternion* boxRotation, bool raycasting, bool placeable)
@@ -829,6 +838,93 @@ namespace Physic
             return std::make_pair(false, 1.0f);
     }
 
+    namespace
+    {
+        // Collects the objects whose bounding box overlaps the bounding box of a sweep
+        struct SweepCandidateCallback : public btDbvt::ICollide
+        {
+            int mFilterGroup;
+            int mFilterMask;
+            std::vector<std::pair<std::size_t, const btCollisionObject*> > mCandidates;
+
+            SweepCandidateCallback(int filterGroup, int filterMask)
+                : mFilterGroup(filterGroup), mFilterMask(filterMask) {}
+
+            virtual void Process(const btDbvtNode* sweep, const btDbvtNode* object)
+            {
+                const btBroadphaseProxy* proxy = static_cast<const btBroadphaseProxy*>(object->data);
+
+                if ((proxy->m_collisionFilterGroup & mFilterMask) && (proxy->m_collisionFilterMask & mFilterGroup))
+                    mCandidates.push_back(std::make_pair(reinterpret_cast<std::size_t>(sweep->data),
+                                                         static_cast<const btCollisionObject*>(proxy->m_clientObject)));
+            }
+        };
+
+        bool sweepHitCmp(const SweepHit& left, const SweepHit& right)
+        {
+            if (left.mSweep != right.mSweep)
+                return left.mSweep < right.mSweep;
+            return left.mFraction < right.mFraction;
+        }
+    }
+
+    void PhysicEngine::sweepSpheres(const std::vector<SphereSweep>& sweeps, std::vector<SweepHit>& hits,
+                                    int filterGroup, int filterMask) const
+    {
+        hits.clear();
+
+        // A temporary tree of the sweeps' bounding boxes, so the broadphase is traversed only once for all of them
+        btDbvt sweepTree;
+        for (std::size_t i=0; i<sweeps.size(); ++i)
+        {
+            const SphereSweep& sweep = sweeps[i];
+            btVector3 extent(sweep.mRadius, sweep.mRadius, sweep.mRadius);
+
+            btVector3 min = sweep.mFrom;
+            min.setMin(sweep.mTo);
+            btVector3 max = sweep.mFrom;
+            max.setMax(sweep.mTo);
+
+            sweepTree.insert(btDbvtVolume::FromMM(min - extent, max + extent), reinterpret_cast<void*>(i));
+        }
+
+        // The broadphase is always a btDbvtBroadphase, see the constructor. Its set 0 holds moving
+        // objects and set 1 static ones.
+        const btDbvtBroadphase* dbvtBroadphase = static_cast<const btDbvtBroadphase*>(broadphase);
+
+        SweepCandidateCallback candidates(filterGroup, filterMask);
+        sweepTree.collideTT(sweepTree.m_root, dbvtBroadphase->m_sets[0].m_root, candidates);
+        sweepTree.collideTT(sweepTree.m_root, dbvtBroadphase->m_sets[1].m_root, candidates);
+
+        const btQuaternion btrot(0.0f, 0.0f, 0.0f);
+
+        for (std::vector<std::pair<std::size_t, const btCollisionObject*> >::const_iterator it = candidates.mCandidates.begin();
+             it != candidates.mCandidates.end(); ++it)
+        {
+            const SphereSweep& sweep = sweeps[it->first];
+            const btCollisionObject* object = it->second;
+
+            btSphereShape shape(sweep.mRadius);
+            btTransform from(btrot, sweep.mFrom);
+            btTransform to(btrot, sweep.mTo);
+
+            btCollisionWorld::ClosestConvexResultCallback callback(sweep.mFrom, sweep.mTo);
+            btCollisionWorld::objectQuerySingle(&shape, from, to, const_cast<btCollisionObject*>(object),
+                                                object->getCollisionShape(), object->getWorldTransform(), callback, 0.f);
+
+            if (callback.hasHit())
+            {
+                SweepHit hit;
+                hit.mSweep = it->first;
+                hit.mFraction = callback.m_closestHitFraction;
+                hit.mObject = static_cast<const RigidBody*>(object);
+                hits.push_back(hit);
+            }
+        }
+
+        std::sort(hits.begin(), hits.end(), sweepHitCmp);
+    }
+
     std::vector< std::pair<float, std::string> > PhysicEngine::rayTest2(const btVector3& from, const btVector3& to, int filterGroup)
     {
         MyRayResultCallback resultCallback1;
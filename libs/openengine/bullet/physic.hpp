@@ -172,6 +172,21 @@ namespace Physic
     };
 
 
+    /// A sphere moving along a line segment, see PhysicEngine::sweepSpheres
+    struct SphereSweep
+    {
+        btVector3 mFrom;
+        btVector3 mTo;
+        float mRadius;
+    };
+
+    struct SweepHit
+    {
+        std::size_t mSweep; //< Index of the sweep in the list passed to sweepSpheres
+        float mFraction; //< Relative distance along the sweep
+        const RigidBody* mObject;
+    };
+
     struct HeightField
     {
         btHeightfieldTerrainShape* mShape;
@@ -224,6 +239,12 @@ namespace Physic
          Mainly used to (but not limited to) adjust rigid bodies based on box shapes to the right position and rotation.
          */
         void boxAdjustExternal(const std::string &mesh, RigidBody* body, float scale, const Ogre::Vector3 &position, const Ogre::Quaternion &rotation);
+
+        /**
+         * Create the collision shapes for a mesh at the given scale, without creating a body.
+         * Bodies created later from the same mesh and scale will reuse them.
+         */
+        void loadShape(const std::string &mesh, float scale);
         /**
          * Add a HeightField to the simulation
          */
@@ -305,6 +326,16 @@ namespace Physic
         std::pair<bool, float> sphereCast (float radius, btVector3& from, btVector3& to);
         ///< @return (hit, relative distance)
 
+        /**
+         * Find all objects hit by a batch of moving spheres. The hits are sorted by sweep and then by
+         * distance, with at most one hit per sweep and object.
+         * All sweeps are matched against the broadphase in a single pass, and only overlapping pairs are
+         * tested exactly. The collision world is not modified, so this may run on another thread as long
+         * as no other thread modifies the world meanwhile.
+         */
+        void sweepSpheres(const std::vector<SphereSweep>& sweeps, std::vector<SweepHit>& hits,
+                          int filterGroup, int filterMask) const;
+
         std::vector<std::string> getCollisions(const std::string& name, int collisionGroup, int collisionMask);
 
         // Get the nearest object that's inside the given object, filtering out objects of the
@@ -10,6 +10,11 @@ namespace Misc {
         std::srand(static_cast<unsigned int>(std::time(NULL)));
     }
 
+    void Rng::init(unsigned int seed)
+    {
+        std::srand(seed);
+    }
+
     float Rng::rollProbability()
     {
         return static_cast<float>(std::rand() / (static_cast<double>(RAND_MAX)+1.0));
@@ -17,6 +17,9 @@ public:
     /// seed the RNG
     static void init();
 
+    /// seed the RNG with a fixed value, for reproducible runs
+    static void init(unsigned int seed);
+
     /// return value in range [0.0f, 1.0f)  <- note open upper range.
     static float rollProbability();
   
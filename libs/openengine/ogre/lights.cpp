@@ -1,17 +1,86 @@
 #include "lights.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
 #include <OgreLight.h>
+#include <OgreMath.h>
+#include <OgreRoot.h>
+#include <OgreSceneManager.h>
+
+
+namespace
+{
+    // Size of a grid cell in world units; an exterior cell is 8192 units wide
+    const float sGridCellSize = 1024.f;
+
+    // Lights or objects overlapping more grid cells per axis are handled without the grid
+    const int sMaxGridCells = 8;
+
+    int gridCoord(float value)
+    {
+        return static_cast<int>(std::floor(value / sGridCellSize));
+    }
+
+    template<typename T>
+    struct GridCmp
+    {
+        typedef std::pair<std::pair<int, int>, T> Entry;
 
+        bool operator() (const Entry& left, const std::pair<int, int>& right) const
+        {
+            return left.first < right;
+        }
+
+        bool operator() (const std::pair<int, int>& left, const Entry& right) const
+        {
+            return left < right.first;
+        }
+    };
+}
 
 namespace OEngine {
 namespace Render {
 
-Ogre::Real LightFunction::pulseAmplitude(Ogre::Real time)
+LightManager* LightManager::sThis = 0;
+
+LightManager::LightManager(Ogre::SceneManager* sceneMgr, unsigned int maxLights)
+  : mSceneMgr(sceneMgr)
+  , mMaxLights(maxLights)
+  , mGridDirty(true)
+  , mQueriedFrame(~0ul)
+  , mQueriedObjectsSorted(true)
+  , mOtherLightsFrame(~0ul)
+  , mOtherLightsDirty(~0ul)
+{
+    assert(!sThis);
+    sThis = this;
+}
+
+LightManager::~LightManager()
+{
+    for (std::vector<Ogre::Light*>::iterator it = mLights.begin(); it != mLights.end(); ++it)
+        (*it)->setListener(NULL);
+
+    for (ObjectMap::iterator it = mObjects.begin(); it != mObjects.end(); ++it)
+        const_cast<Ogre::MovableObject*>(it->first)->setListener(NULL);
+
+    sThis = 0;
+}
+
+LightManager& LightManager::getInstance()
+{
+    assert(sThis);
+    return *sThis;
+}
+
+Ogre::Real LightManager::pulseAmplitude(Ogre::Real time)
 {
     return std::sin(time);
 }
 
-Ogre::Real LightFunction::flickerAmplitude(Ogre::Real time)
+Ogre::Real LightManager::flickerAmplitude(Ogre::Real time)
 {
     static const float fb = 1.17024f;
     static const float f[3] = { 1.5708f,   4.18774f, 5.19934f };
@@ -25,7 +94,7 @@ Ogre::Real LightFunction::flickerAmplitude(Ogre::Real time)
     return v * s;
 }
 
-Ogre::Real LightFunction::flickerFrequency(Ogre::Real phase)
+Ogre::Real LightManager::flickerFrequency(Ogre::Real phase)
 {
     static const float fa = 0.785398f;
     static const float tdo = 0.94f;
@@ -34,68 +103,350 @@ Ogre::Real LightFunction::flickerFrequency(Ogre::Real phase)
     return tdo + tdm*std::sin(fa * phase);
 }
 
-Ogre::Real LightFunction::calculate(Ogre::Real value)
+void LightManager::addLight(Ogre::Light* light, LightType type, const Ogre::ColourValue& colour)
 {
-    Ogre::Real brightness = 1.0f;
-    float cycle_time;
-    float time_distortion;
+    mLightIndices[light] = mLights.size();
 
-    if(mType == LT_Pulse || mType == LT_PulseSlow)
-    {
-        cycle_time = 2.0f * Ogre::Math::PI;
-        time_distortion = 20.0f;
-    }
-    else
+    mLights.push_back(light);
+    mTypes.push_back(type);
+    mColours.push_back(colour);
+    mPhases.push_back(Ogre::Math::RangeRandom(-500.0f, +500.0f));
+    mDirections.push_back(1.0f);
+    mDeltaCounts.push_back(0.0f);
+    mBrightness.push_back(1.0f);
+
+    GridRange range = { 0, 0, -1, -1, false };
+    mGridRanges.push_back(range);
+
+    light->setDiffuseColour(colour);
+    light->setListener(this);
+
+    mGridDirty = true;
+}
+
+void LightManager::addObject(Ogre::MovableObject* object)
+{
+    if (object->_getManager() != mSceneMgr)
+        return;
+
+    if (object->getListener() && object->getListener() != this)
+        return;
+
+    object->setListener(this);
+
+    CachedLights& cached = mObjects[object];
+    cached.mFrame = ~0ul;
+    cached.mLightsDirty = ~0ul;
+    cached.mLights.clear();
+}
+
+void LightManager::removeLight(size_t index)
+{
+    // The selected lights of this frame may refer to the light
+    invalidateObjects(mGridRanges[index]);
+    mGridDirty = true;
+
+    mLightIndices.erase(mLights[index]);
+
+    size_t last = mLights.size()-1;
+    if (index != last)
     {
-        static const float fa = 0.785398f;
-        static const float phase_wavelength = 120.0f * 3.14159265359f / fa;
+        mLights[index] = mLights[last];
+        mTypes[index] = mTypes[last];
+        mColours[index] = mColours[last];
+        mPhases[index] = mPhases[last];
+        mDirections[index] = mDirections[last];
+        mDeltaCounts[index] = mDeltaCounts[last];
+        mBrightness[index] = mBrightness[last];
+        mGridRanges[index] = mGridRanges[last];
 
-        cycle_time = 500.0f;
-        mPhase = std::fmod(mPhase + value, phase_wavelength);
-        time_distortion = flickerFrequency(mPhase);
+        mLightIndices[mLights[index]] = index;
     }
 
-    mDeltaCount += mDirection*value*time_distortion;
-    if(mDirection > 0 && mDeltaCount > +cycle_time)
+    mLights.pop_back();
+    mTypes.pop_back();
+    mColours.pop_back();
+    mPhases.pop_back();
+    mDirections.pop_back();
+    mDeltaCounts.pop_back();
+    mBrightness.pop_back();
+    mGridRanges.pop_back();
+}
+
+void LightManager::invalidateObjects(const GridRange& range)
+{
+    if (mQueriedFrame != Ogre::Root::getSingleton().getNextFrameNumber())
+        return; // cached light lists are only used within the frame they were selected in
+
+    if (range.mLarge)
     {
-        mDirection = -1.0f;
-        mDeltaCount = 2.0f*cycle_time - mDeltaCount;
+        for (ObjectGrid::const_iterator it = mQueriedObjects.begin(); it != mQueriedObjects.end(); ++it)
+        {
+            ObjectMap::iterator object = mObjects.find(it->second);
+            if (object != mObjects.end())
+                object->second.mFrame = ~0ul;
+        }
+        return;
     }
-    if(mDirection < 0 && mDeltaCount < -cycle_time)
+
+    if (!mQueriedObjectsSorted)
     {
-        mDirection = +1.0f;
-        mDeltaCount = -2.0f*cycle_time - mDeltaCount;
+        std::sort(mQueriedObjects.begin(), mQueriedObjects.end());
+        mQueriedObjectsSorted = true;
     }
 
+    for (int x = range.mX0; x <= range.mX1; ++x)
+        for (int y = range.mY0; y <= range.mY1; ++y)
+        {
+            std::pair<ObjectGrid::const_iterator, ObjectGrid::const_iterator> objects =
+                std::equal_range(mQueriedObjects.begin(), mQueriedObjects.end(), GridIndex(x, y),
+                    GridCmp<const Ogre::MovableObject*>());
+
+            for (ObjectGrid::const_iterator it = objects.first; it != objects.second; ++it)
+            {
+                ObjectMap::iterator object = mObjects.find(it->second);
+                if (object != mObjects.end())
+                    object->second.mFrame = ~0ul;
+            }
+        }
+}
+
+void LightManager::update(float duration)
+{
+    static const float fa = 0.785398f;
+    static const float phase_wavelength = 120.0f * 3.14159265359f / fa;
+
     static const float fast = 4.0f/1.0f;
     static const float slow = 1.0f/1.0f;
 
-    // These formulas are just guesswork, but they work pretty well
-    if(mType == LT_Normal)
+    const size_t count = mLights.size();
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const LightType type = mTypes[i];
+
+        float cycle_time;
+        float time_distortion;
+
+        if(type == LT_Pulse || type == LT_PulseSlow)
+        {
+            cycle_time = 2.0f * Ogre::Math::PI;
+            time_distortion = 20.0f;
+        }
+        else
+        {
+            cycle_time = 500.0f;
+            mPhases[i] = std::fmod(mPhases[i] + duration, phase_wavelength);
+            time_distortion = flickerFrequency(mPhases[i]);
+        }
+
+        Ogre::Real& deltaCount = mDeltaCounts[i];
+        Ogre::Real& direction = mDirections[i];
+
+        deltaCount += direction*duration*time_distortion;
+        if(direction > 0 && deltaCount > +cycle_time)
+        {
+            direction = -1.0f;
+            deltaCount = 2.0f*cycle_time - deltaCount;
+        }
+        if(direction < 0 && deltaCount < -cycle_time)
+        {
+            direction = +1.0f;
+            deltaCount = -2.0f*cycle_time - deltaCount;
+        }
+
+        // These formulas are just guesswork, but they work pretty well
+        if(type == LT_Normal)
+        {
+            // Less than 1/255 light modifier for a constant light:
+            mBrightness[i] = 1.0f + flickerAmplitude(deltaCount*slow)/255.0f;
+        }
+        else if(type == LT_Flicker)
+            mBrightness[i] = 0.75f + flickerAmplitude(deltaCount*fast)*0.25f;
+        else if(type == LT_FlickerSlow)
+            mBrightness[i] = 0.75f + flickerAmplitude(deltaCount*slow)*0.25f;
+        else if(type == LT_Pulse)
+            mBrightness[i] = 1.0f + pulseAmplitude(deltaCount*fast)*0.25f;
+        else if(type == LT_PulseSlow)
+            mBrightness[i] = 1.0f + pulseAmplitude(deltaCount*slow)*0.25f;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        mLights[i]->setDiffuseColour(mColours[i] * mBrightness[i]);
+
+    // Lights attached to actors move; bin them once the scene is final, when rendering starts
+    mGridDirty = true;
+}
+
+void LightManager::buildGrid()
+{
+    mGrid.clear();
+    mLargeLights.clear();
+
+    for (size_t i = 0; i < mLights.size(); ++i)
+    {
+        Ogre::Light* light = mLights[i];
+        GridRange& binned = mGridRanges[i];
+
+        binned.mX0 = binned.mY0 = 0;
+        binned.mX1 = binned.mY1 = -1;
+        binned.mLarge = false;
+
+        if (light->_getManager() != mSceneMgr || !light->isInScene() || !light->getVisible())
+            continue;
+
+        const Ogre::Vector3& pos = light->getDerivedPosition();
+        Ogre::Real range = light->getAttenuationRange();
+
+        int x0 = gridCoord(pos.x - range);
+        int x1 = gridCoord(pos.x + range);
+        int y0 = gridCoord(pos.y - range);
+        int y1 = gridCoord(pos.y + range);
+
+        // Lights reaching this far are rare; they are tested against every object
+        if (x1-x0 >= sMaxGridCells || y1-y0 >= sMaxGridCells)
+        {
+            mLargeLights.push_back(light);
+            binned.mLarge = true;
+            continue;
+        }
+
+        binned.mX0 = x0;
+        binned.mY0 = y0;
+        binned.mX1 = x1;
+        binned.mY1 = y1;
+
+        for (int x = x0; x <= x1; ++x)
+            for (int y = y0; y <= y1; ++y)
+                mGrid.push_back(std::make_pair(GridIndex(x, y), light));
+    }
+
+    std::sort(mGrid.begin(), mGrid.end());
+
+    mGridDirty = false;
+}
+
+void LightManager::collectOtherLights()
+{
+    mOtherLights.clear();
+
+    const Ogre::LightList& lights = mSceneMgr->_getLightsAffectingFrustum();
+    for (Ogre::LightList::const_iterator it = lights.begin(); it != lights.end(); ++it)
     {
-        // Less than 1/255 light modifier for a constant light:
-        brightness = 1.0f + flickerAmplitude(mDeltaCount*slow)/255.0f;
+        if (mLightIndices.find(*it) == mLightIndices.end())
+            mOtherLights.push_back(*it);
     }
-    else if(mType == LT_Flicker)
-        brightness = 0.75f + flickerAmplitude(mDeltaCount*fast)*0.25f;
-    else if(mType == LT_FlickerSlow)
-        brightness = 0.75f + flickerAmplitude(mDeltaCount*slow)*0.25f;
-    else if(mType == LT_Pulse)
-        brightness = 1.0f + pulseAmplitude(mDeltaCount*fast)*0.25f;
-    else if(mType == LT_PulseSlow)
-        brightness = 1.0f + pulseAmplitude(mDeltaCount*slow)*0.25f;
+}
+
+void LightManager::addCandidate(Ogre::Light* light, const Ogre::Vector3& center, Ogre::Real radius)
+{
+    Ogre::Real squaredDist = (light->getDerivedPosition() - center).squaredLength();
+    Ogre::Real reach = light->getAttenuationRange() + radius;
 
-    return brightness;
+    if (squaredDist <= reach*reach)
+        mCandidates.push_back(std::make_pair(squaredDist, light));
 }
 
-Ogre::Real LightValue::getValue() const
+void LightManager::objectDestroyed(Ogre::MovableObject* object)
 {
-    return 0.0f;
+    std::map<const Ogre::MovableObject*, size_t>::iterator light = mLightIndices.find(object);
+    if (light != mLightIndices.end())
+        removeLight(light->second);
+    else
+        mObjects.erase(object);
 }
 
-void LightValue::setValue(Ogre::Real value)
+const Ogre::LightList* LightManager::objectQueryLights(const Ogre::MovableObject* object)
 {
-    mTarget->setDiffuseColour(mColor * value);
+    ObjectMap::iterator found = mObjects.find(object);
+    if (found == mObjects.end())
+        return NULL;
+
+    CachedLights& cached = found->second;
+
+    unsigned long frame = Ogre::Root::getSingleton().getNextFrameNumber();
+    unsigned long lightsDirty = mSceneMgr->_getLightsDirtyCounter();
+
+    if (cached.mFrame == frame && cached.mLightsDirty == lightsDirty)
+        return &cached.mLights;
+
+    const Ogre::Sphere& sphere = object->getWorldBoundingSphere();
+    const Ogre::Vector3& center = sphere.getCenter();
+    Ogre::Real radius = sphere.getRadius();
+
+    int x0 = gridCoord(center.x - radius);
+    int x1 = gridCoord(center.x + radius);
+    int y0 = gridCoord(center.y - radius);
+    int y1 = gridCoord(center.y + radius);
+
+    // Leave large objects to Ogre
+    if (x1-x0 >= sMaxGridCells || y1-y0 >= sMaxGridCells)
+        return NULL;
+
+    if (mGridDirty)
+        buildGrid();
+
+    if (mOtherLightsFrame != frame || mOtherLightsDirty != lightsDirty)
+    {
+        collectOtherLights();
+        mOtherLightsFrame = frame;
+        mOtherLightsDirty = lightsDirty;
+    }
+
+    if (mQueriedFrame != frame)
+    {
+        mQueriedObjects.clear();
+        mQueriedFrame = frame;
+    }
+
+    for (int x = x0; x <= x1; ++x)
+        for (int y = y0; y <= y1; ++y)
+            mQueriedObjects.push_back(std::make_pair(GridIndex(x, y), object));
+
+    mQueriedObjectsSorted = false;
+
+    mCandidates.clear();
+
+    for (int x = x0; x <= x1; ++x)
+        for (int y = y0; y <= y1; ++y)
+        {
+            std::pair<Grid::const_iterator, Grid::const_iterator> range =
+                std::equal_range(mGrid.begin(), mGrid.end(), GridIndex(x, y), GridCmp<Ogre::Light*>());
+
+            for (Grid::const_iterator it = range.first; it != range.second; ++it)
+                addCandidate(it->second, center, radius);
+        }
+
+    for (std::vector<Ogre::Light*>::const_iterator it = mLargeLights.begin(); it != mLargeLights.end(); ++it)
+        addCandidate(*it, center, radius);
+
+    for (Ogre::LightList::const_iterator it = mOtherLights.begin(); it != mOtherLights.end(); ++it)
+    {
+        if ((*it)->getType() == Ogre::Light::LT_DIRECTIONAL)
+        {
+            // Directional lights come first, like Ogre sorts them
+            mCandidates.push_back(std::make_pair(Ogre::Real(-1), *it));
+        }
+        else
+            addCandidate(*it, center, radius);
+    }
+
+    // A light overlapping several cells that the object overlaps too was found more than once
+    std::sort(mCandidates.begin(), mCandidates.end());
+    mCandidates.erase(std::unique(mCandidates.begin(), mCandidates.end()), mCandidates.end());
+
+    if (mCandidates.size() > mMaxLights)
+        mCandidates.resize(mMaxLights);
+
+    cached.mLights.clear();
+    for (std::vector<std::pair<Ogre::Real, Ogre::Light*> >::const_iterator it = mCandidates.begin();
+         it != mCandidates.end(); ++it)
+        cached.mLights.push_back(it->second);
+
+    cached.mFrame = frame;
+    cached.mLightsDirty = lightsDirty;
+
+    return &cached.mLights;
 }
 
 }
@@ -1,14 +1,24 @@
 #ifndef OENGINE_OGRE_LIGHTS_H
 #define OENGINE_OGRE_LIGHTS_H
 
-#include <OgreController.h>
+#include <map>
+#include <utility>
+#include <vector>
+
 #include <OgreColourValue.h>
-#include <OgreMath.h>
+#include <OgreMovableObject.h>
+#include <OgreCommon.h>
 
 /*
- * Controller classes to handle pulsing and flicker lights
+ * Animation of pulsing and flicker lights, and selection of the lights affecting each object
  */
 
+namespace Ogre
+{
+    class Light;
+    class SceneManager;
+}
+
 namespace OEngine {
 namespace Render {
     enum LightType {
@@ -19,44 +29,109 @@ namespace Render {
         LT_PulseSlow
     };
 
-    class LightFunction : public Ogre::ControllerFunction<Ogre::Real>
+    /// \brief Animates the lights of objects and selects the lights affecting each object of a scene
+    ///
+    /// The brightness of all lights is updated in a single pass over contiguous arrays, instead of
+    /// running a controller per light. Point lights of the scene are binned in a grid once per frame,
+    /// so that the lights affecting an object are found by looking at the grid cells it overlaps,
+    /// instead of Ogre comparing every object with every visible light and sorting them.
+    class LightManager : public Ogre::MovableObject::Listener
     {
-        LightType mType;
-        Ogre::Real mPhase;
-        Ogre::Real mDirection;
-
-        static Ogre::Real pulseAmplitude(Ogre::Real time);
-
-        static Ogre::Real flickerAmplitude(Ogre::Real time);
-        static Ogre::Real flickerFrequency(Ogre::Real phase);
-
-    public:
-        // MSVC needs the constructor for a class inheriting a template to be defined in header
-        LightFunction(LightType type)
-          : ControllerFunction<Ogre::Real>(true)
-          , mType(type)
-          , mPhase(Ogre::Math::RangeRandom(-500.0f, +500.0f))
-          , mDirection(1.0f)
-        {
-        }
-        virtual Ogre::Real calculate(Ogre::Real value);
-    };
+            struct CachedLights
+            {
+                unsigned long mFrame;
+                unsigned long mLightsDirty;
+                Ogre::LightList mLights;
+            };
 
-    class LightValue : public Ogre::ControllerValue<Ogre::Real>
-    {
-        Ogre::Light *mTarget;
-        Ogre::ColourValue mColor;
-
-    public:
-        // MSVC needs the constructor for a class inheriting a template to be defined in header
-        LightValue(Ogre::Light *light, const Ogre::ColourValue &color)
-          : mTarget(light)
-          , mColor(color)
-        {
-        }
-
-        virtual Ogre::Real getValue() const;
-        virtual void setValue(Ogre::Real value);
+            typedef std::pair<int, int> GridIndex;
+            typedef std::vector<std::pair<GridIndex, Ogre::Light*> > Grid;
+            typedef std::vector<std::pair<GridIndex, const Ogre::MovableObject*> > ObjectGrid;
+            typedef std::map<const Ogre::MovableObject*, CachedLights> ObjectMap;
+
+            struct GridRange
+            {
+                int mX0, mY0, mX1, mY1; // empty if mX0>mX1
+                bool mLarge;
+            };
+
+            static LightManager* sThis;
+
+            Ogre::SceneManager* mSceneMgr;
+            unsigned int mMaxLights;
+
+            // Animation state of the lights, one entry per light
+            std::vector<Ogre::Light*> mLights;
+            std::vector<LightType> mTypes;
+            std::vector<Ogre::ColourValue> mColours;
+            std::vector<Ogre::Real> mPhases;
+            std::vector<Ogre::Real> mDirections;
+            std::vector<Ogre::Real> mDeltaCounts;
+            std::vector<Ogre::Real> mBrightness;
+            std::vector<GridRange> mGridRanges; // grid cells the light was binned in
+            std::map<const Ogre::MovableObject*, size_t> mLightIndices;
+
+            Grid mGrid; // sorted by grid index
+            std::vector<Ogre::Light*> mLargeLights; // lights covering too many grid cells
+            bool mGridDirty;
+
+            ObjectMap mObjects;
+
+            // Objects whose lights were selected in the current frame, by the grid cells they overlap
+            ObjectGrid mQueriedObjects;
+            unsigned long mQueriedFrame;
+            bool mQueriedObjectsSorted;
+
+            // Visible lights that are not animated by this manager, e.g. the sun
+            Ogre::LightList mOtherLights;
+            unsigned long mOtherLightsFrame;
+            unsigned long mOtherLightsDirty;
+
+            std::vector<std::pair<Ogre::Real, Ogre::Light*> > mCandidates;
+
+            LightManager (const LightManager&);
+            LightManager& operator= (const LightManager&);
+
+            static Ogre::Real pulseAmplitude(Ogre::Real time);
+
+            static Ogre::Real flickerAmplitude(Ogre::Real time);
+            static Ogre::Real flickerFrequency(Ogre::Real phase);
+
+            void removeLight(size_t index);
+
+            void invalidateObjects(const GridRange& range);
+            ///< Select the lights again for objects of the current frame that overlap \a range.
+
+            void buildGrid();
+
+            void collectOtherLights();
+
+            void addCandidate(Ogre::Light* light, const Ogre::Vector3& center, Ogre::Real radius);
+            ///< Consider \a light for an object, if it reaches the object's bounding sphere.
+
+        public:
+
+            LightManager(Ogre::SceneManager* sceneMgr, unsigned int maxLights);
+            ///< \param maxLights Number of lights passed to the shaders for each object
+
+            virtual ~LightManager();
+
+            static LightManager& getInstance();
+
+            void addLight(Ogre::Light* light, LightType type, const Ogre::ColourValue& colour);
+            ///< Animate a point light until it is destroyed. Its diffuse colour is set to \a colour
+            /// scaled by the brightness of \a type.
+
+            void addObject(Ogre::MovableObject* object);
+            ///< Select the lights for \a object, until it is destroyed. Objects of other scenes are
+            /// left to Ogre.
+
+            void update(float duration);
+            ///< Animate all lights. They are binned again when the first object of the frame is rendered.
+
+            virtual void objectDestroyed(Ogre::MovableObject* object);
+
+            virtual const Ogre::LightList* objectQueryLights(const Ogre::MovableObject* object);
     };
 }
 }
@@ -132,7 +132,7 @@ void OgreRenderer::createWindow(const std::string &title, const WindowSettings&
       pos_y,             // initial y position
       settings.window_x, // width, in pixels
       settings.window_y, // height, in pixels
-      SDL_WINDOW_SHOWN
+      (settings.hidden ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN)
         | SDL_WINDOW_RESIZABLE
         | (settings.fullscreen ? SDL_WINDOW_FULLSCREEN : 0)
         | (settings.window_border ? 0 : SDL_WINDOW_BORDERLESS)
@@ -39,6 +39,7 @@ namespace OEngine
             bool vsync;
             bool fullscreen;
             bool window_border;
+            bool hidden;
             int window_x, window_y;
             int screen;
             std::string fsaa;